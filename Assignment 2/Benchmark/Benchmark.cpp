@@ -0,0 +1,84 @@
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+/*
+	Benchmark is a console program that measures the performance of Charles and writes
+	the results as JSON (see Meting.h) to standard output or to the file given with --out.
+
+	Usage: Benchmark [--no-render] [--suite micro|macro|all] [--out file.json] [--trace trace.json]
+
+	--no-render		skip the benchmarks that need the RobotGUI window
+	--suite			run only the micro benchmarks (Micro.cpp) or the macro workloads (Macro.cpp)
+	--trace			record a timeline of the run (see Spoor.h) and write it in the Chrome trace format
+*/
+
+#include "Robot.h"
+#include "Meting.h"
+#include "Spoor.h"
+
+using namespace std;
+
+int main (int argc, char *argv [])
+{
+	bool		met_tekenen = true;
+	const char	*uitvoer    = NULL;
+	const char	*suite      = "all";
+	const char	*spoor      = NULL;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp (argv [i], "--no-render") == 0)
+			met_tekenen = false;
+		else if (strcmp (argv [i], "--out") == 0 && i + 1 < argc)
+			uitvoer = argv [++i];
+		else if (strcmp (argv [i], "--suite") == 0 && i + 1 < argc)
+			suite = argv [++i];
+		else if (strcmp (argv [i], "--trace") == 0 && i + 1 < argc)
+			spoor = argv [++i];
+		else
+		{
+			cerr << "Usage: " << argv [0] << " [--no-render] [--suite micro|macro|all] [--out file.json] [--trace trace.json]" << endl;
+			return 2;
+		}
+	}
+
+	Meting meting;
+	if (spoor != NULL)
+		startSpoor ();
+	try
+	{
+		if (met_tekenen)
+			karelsWereld().Open (WINARGS (GetModuleHandle (NULL), NULL, (PSTR)"", SW_SHOW));
+		if (strcmp (suite, "macro") != 0)
+			microBenchmarks (meting, met_tekenen);
+		if (strcmp (suite, "micro") != 0)
+			macroBenchmarks (meting, met_tekenen);
+	}
+	catch (IllegaleActie dezeIllegaleActie)
+	{
+		cerr << "Benchmark stopped by an illegal action of Charles (" << dezeIllegaleActie.actie () << ")" << endl;
+		return 1;
+	}
+	catch (GUIException& e)
+	{
+		cerr << "Benchmark stopped by a GUI error" << endl;
+		return 1;
+	}
+
+	if (spoor != NULL)
+	{
+		stopSpoor ();
+		ofstream bestand (spoor);
+		schrijfChromeTrace (bestand);
+	}
+
+	if (uitvoer != NULL)
+	{
+		ofstream bestand (uitvoer);
+		meting.schrijfJSON (bestand);
+	}
+	else
+		meting.schrijfJSON (cout);
+	return 0;
+}
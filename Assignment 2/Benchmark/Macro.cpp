@@ -0,0 +1,170 @@
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include <vector>
+#include <windows.h>
+#include <psapi.h>
+
+/*
+	Macro benchmarks: the routines of Charles.cpp run end-to-end on seeded worlds of
+	increasing size. The world is generated, drawn once (time-to-first-frame) and then
+	the routine runs with drawing switched off, so the throughput is that of the robot
+	and not that of the pause between steps.
+
+	Reported per scenario and world size:
+	*	steps				the number of primitives Charles performed (moves, turns and tests)
+	*	seconds				the median run time of the routine
+	*	steps_per_second	steps divided by the median run time
+	*	ttff_ms				time from an empty world to the first complete frame (only with a window)
+	*	working_set			the working set of the process after the last run, which starts with
+							an emptied working set: about the bytes the scenario touched
+	*	completed			1 if the routine returned normally or ended itself with stop or exit
+							(EindeRoutine, Robot.h); 0 if it was stopped by an illegal action or by
+							the action limit, in which case illegal_action holds its IllegaleActies code
+*/
+
+#include "Robot.h"
+#include "Meting.h"
+
+using namespace std;
+
+//	The routines of Charles.cpp:
+extern void execution () ;
+extern void Opdracht1 () ;
+extern void Bonus () ;
+
+static const unsigned	macro_seed			= 20140910;
+static const int		macro_herhalingen	= 3;
+
+//	make_church of Charles.cpp sizes the church by WereldBreedte and WereldHoogte and puts the
+//	ball on row WereldHoogte - 2, which is the row Charles starts on only in a 50x30 world.
+//	maakKerk builds the same church scaled to the world of the scenario, with the ball on the
+//	row where reset puts Charles, so that Bonus finds it in every size.
+static void maakKerk ()
+{
+	const int breedte = wereldVanKarel ().breedte ();
+	const int hoogte  = wereldVanKarel ().hoogte ();
+	reset () ;
+	const int lane   = 2 + rand () % (hoogte / 5) ;
+	const int street = 2 + rand () % (breedte / 5) ;
+	const int width  = 3 + rand () % (breedte / 2) ;
+	const int height = 2 + rand () % (hoogte / 3) ;
+	begin_edit () ;
+	place_rectangle (street, lane, width, height) ;
+	place_rectangle (street + 2, lane + height, 2 + width / 3, 2 + height / 3) ;
+	place_walls (street + 3 + width / 6, lane + height + height / 3 + 3, 4, false) ;
+	place_walls (street + 2 + width / 6, lane + height + height / 3 + 5, 2, true) ;
+	create_ball (street, hoogte - 2) ;
+	commit_edit () ;
+}
+
+struct Scenario
+{
+	const char	*naam;
+	void		(*bouw)		();		// generates the world
+	void		(*routine)	();		// the routine that is measured
+} ;
+
+static const Scenario scenarios [] =
+{	{ "execution",       make_cave,            execution       }
+,	{ "Opdracht1",       make_path_with_balls, Opdracht1       }
+,	{ "Bonus",           maakKerk,             Bonus           }
+} ;
+
+static const int groottes [][2] = { {50, 30}, {100, 60}, {200, 120}, {400, 240}, {800, 480} } ;
+
+//	The peak working set of Windows is that of the whole life of the process, so every scenario
+//	after the largest one would report its peak. Instead the working set is emptied before the
+//	last run of a scenario, and measured after it; the median of the run times hides the page
+//	faults that this costs the last run.
+static void leegWerkset ()
+{
+	SetProcessWorkingSetSize (GetCurrentProcess (), (SIZE_T) -1, (SIZE_T) -1);
+}
+
+static double werkset ()
+{
+	PROCESS_MEMORY_COUNTERS geheugen;
+	geheugen.cb = sizeof (geheugen);
+	if (GetProcessMemoryInfo (GetCurrentProcess (), &geheugen, sizeof (geheugen)))
+		return (double) geheugen.WorkingSetSize;
+	return 0;
+}
+
+static void draai (const Scenario& scenario, int breedte, int hoogte, bool met_tekenen, Meting& meting)
+{
+	vector<double> seconden;
+	long long stappen  = 0;
+	int       gestopt  = -1;
+	double    ttff_ms  = 0;
+	double    werkset_bytes = 0;
+
+	for (int h = 0; h < macro_herhalingen; h++)
+	{
+		const bool laatste = h == macro_herhalingen - 1;
+		if (laatste)
+			leegWerkset ();
+		srand (macro_seed);
+		teken_modus (false);
+
+		const double begin = Meting::nu_ns ();
+		wereldVanKarel () = Wereld (breedte, hoogte);
+		scenario.bouw ();
+		if (met_tekenen && h == 0)
+		{
+			herteken_deel (0, 0, breedte - 1, hoogte - 1);
+			ttff_ms = (Meting::nu_ns () - begin) / 1e6;
+		}
+
+		actie_limiet (200LL * breedte * hoogte);
+		const double start = Meting::nu_ns ();
+		try
+		{
+			scenario.routine ();
+		}
+		catch (IllegaleActie dezeIllegaleActie)
+		{
+			gestopt = dezeIllegaleActie.actie ();
+		}
+		catch (EindeRoutine)
+		{
+		}
+		seconden.push_back ((Meting::nu_ns () - start) / 1e9);
+		stappen = aantal_acties ();
+		if (laatste)
+			werkset_bytes = werkset ();
+	}
+	actie_limiet (0);
+	teken_modus (true);
+
+	sort (seconden.begin (), seconden.end ());
+	const double mediaan = max (seconden [seconden.size () / 2], 1e-9);
+
+	char naam [64];
+	snprintf (naam, sizeof (naam), "%s/%dx%d", scenario.naam, breedte, hoogte);
+
+	Meting::Waarden waarden;
+	waarden.push_back (make_pair (string ("width"),            (double) breedte));
+	waarden.push_back (make_pair (string ("height"),           (double) hoogte));
+	waarden.push_back (make_pair (string ("steps"),            (double) stappen));
+	waarden.push_back (make_pair (string ("seconds"),          mediaan));
+	waarden.push_back (make_pair (string ("steps_per_second"), stappen / mediaan));
+	if (met_tekenen)
+		waarden.push_back (make_pair (string ("ttff_ms"),      ttff_ms));
+	waarden.push_back (make_pair (string ("working_set"),      werkset_bytes));
+	waarden.push_back (make_pair (string ("completed"),        gestopt < 0 ? 1.0 : 0.0));
+	if (gestopt >= 0)
+		waarden.push_back (make_pair (string ("illegal_action"), (double) gestopt));
+	meting.voegToe ("macro", naam, waarden);
+}
+
+void macroBenchmarks (Meting& meting, bool met_tekenen)
+{
+	for (size_t s = 0; s < sizeof (scenarios) / sizeof (scenarios [0]); s++)
+		for (size_t g = 0; g < sizeof (groottes) / sizeof (groottes [0]); g++)
+			draai (scenarios [s], groottes [g][0], groottes [g][1], met_tekenen, meting);
+
+	wereldVanKarel () = Wereld ();
+	if (met_tekenen)
+		reset ();
+}
@@ -0,0 +1,84 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#include "Meting.h"
+
+using namespace std;
+
+volatile long long Meting :: sink = 0;
+
+//	The Benchmark target replaces the global operator new to count the allocations; every thread
+//	counts its own, so counting does not make the threads of a campaign contend.
+static thread_local long long allocaties = 0;
+
+long long Meting :: heapAllocaties ()
+{
+	return allocaties;
+}
+
+void* operator new (size_t bytes)
+{
+	allocaties++;
+	if (void *p = malloc (bytes != 0 ? bytes : 1))
+		return p;
+	throw bad_alloc ();
+}
+
+void operator delete (void *p) noexcept
+{
+	free (p);
+}
+
+Meting :: Meting (int herhalingen, double minimale_duur_ms)
+	: herhalingen (max (herhalingen, 1)), minimale_duur_ns (minimale_duur_ms * 1e6)
+{
+}
+
+void Meting :: voegToe (const char suite [], const char naam [], const Waarden& waarden)
+{
+	Resultaat resultaat;
+	resultaat.suite   = suite;
+	resultaat.naam    = naam;
+	resultaat.waarden = waarden;
+	resultaten.push_back (resultaat);
+}
+
+//	JSON strings: the benchmark names are plain ASCII, only quotes and backslashes need escaping.
+static string alsJSON (const string& tekst)
+{
+	string json = "\"";
+	for (size_t i = 0; i < tekst.size (); i++)
+	{
+		if (tekst [i] == '"' || tekst [i] == '\\')
+			json += '\\';
+		json += tekst [i];
+	}
+	return json + "\"";
+}
+
+static string getal (double waarde)
+{
+	char tekst [64];
+	if (waarde == (double) (long long) waarde)
+		snprintf (tekst, sizeof (tekst), "%lld", (long long) waarde);
+	else
+		snprintf (tekst, sizeof (tekst), "%.9g", waarde);		// significant digits: run times can be far below 1
+	return tekst;
+}
+
+void Meting :: schrijfJSON (ostream& uit) const
+{
+	uit << "{\n  \"schema\": 1,\n  \"benchmarks\": [\n";
+	for (size_t r = 0; r < resultaten.size (); r++)
+	{
+		const Resultaat& resultaat = resultaten [r];
+		uit << "    { \"suite\": " << alsJSON (resultaat.suite)
+		    << ", \"name\": "      << alsJSON (resultaat.naam);
+		for (size_t w = 0; w < resultaat.waarden.size (); w++)
+			uit << ", " << alsJSON (resultaat.waarden [w].first) << ": " << getal (resultaat.waarden [w].second);
+		uit << " }" << (r + 1 < resultaten.size () ? "," : "") << "\n";
+	}
+	uit << "  ]\n}\n";
+}
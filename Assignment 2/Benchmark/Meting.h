@@ -0,0 +1,112 @@
+#ifndef METING_H
+#define METING_H
+
+#include <algorithm>
+#include <chrono>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+/*
+	Meting is the measuring harness of the Benchmark target.
+
+	meet runs an operation in batches: the batch size is doubled until one batch lasts
+	at least minimale_duur_ms, after which the batch is repeated 'herhalingen' times.
+	The median and the fastest repetition are kept in ns per operation, and the heap
+	allocations per operation over all repetitions: the Benchmark target counts every
+	operator new of the thread it runs on (heapAllocaties), so an operation that should not
+	allocate shows it when it does.
+
+	voegToe records a benchmark with arbitrary named values (used by the macro workloads).
+
+	schrijfJSON writes all results in registration order. The layout is stable so that
+	the output of different releases can be compared line by line:
+
+	{
+	  "schema": 1,
+	  "benchmarks": [
+	    { "suite": "micro", "name": "stap", "iterations": 1048576, "ns_per_op": 3.125, "ns_per_op_min": 3.031, "allocs_per_op": 0 },
+	    ...
+	  ]
+	}
+*/
+
+class Meting
+{
+public:
+	typedef std::vector<std::pair<std::string, double> > Waarden;
+
+				Meting		(int herhalingen = 5, double minimale_duur_ms = 50);
+
+	template <class Operatie>
+	void		meet		(const char suite [], const char naam [], Operatie operatie);
+	void		voegToe		(const char suite [], const char naam [], const Waarden& waarden);
+	void		schrijfJSON	(std::ostream& uit) const;
+
+	static long long	heapAllocaties	();	//	by the calling thread, since it started
+
+	static double	nu_ns	()
+				{	return (double) std::chrono::duration_cast<std::chrono::nanoseconds>
+								(std::chrono::steady_clock::now ().time_since_epoch ()).count ();
+				}
+
+	//	gebruik prevents the compiler from optimising a measured result away.
+	template <class T>
+	static void	gebruik		(const T& waarde) { sink = sink + (long long) waarde; }
+
+private:
+	struct Resultaat
+	{
+		std::string	suite;
+		std::string	naam;
+		Waarden		waarden;
+	} ;
+
+	int						herhalingen;
+	double					minimale_duur_ns;
+	std::vector<Resultaat>	resultaten;
+
+	static volatile long long sink;
+} ;
+
+template <class Operatie>
+void Meting :: meet (const char suite [], const char naam [], Operatie operatie)
+{
+	long long iteraties = 1;
+	for (;;)								// calibrate the batch size
+	{
+		const double begin = nu_ns ();
+		for (long long i = 0; i < iteraties; i++)
+			operatie ();
+		if (nu_ns () - begin >= minimale_duur_ns || iteraties >= (1LL << 40))
+			break;
+		iteraties *= 2;
+	}
+
+	std::vector<double> per_op;
+	per_op.reserve (herhalingen);
+	const long long allocaties = heapAllocaties ();
+	for (int h = 0; h < herhalingen; h++)
+	{
+		const double begin = nu_ns ();
+		for (long long i = 0; i < iteraties; i++)
+			operatie ();
+		per_op.push_back ((nu_ns () - begin) / iteraties);
+	}
+	const double allocaties_per_op = (double) (heapAllocaties () - allocaties) / (herhalingen * iteraties);
+	std::sort (per_op.begin (), per_op.end ());
+
+	Waarden waarden;
+	waarden.push_back (std::make_pair (std::string ("iterations"),    (double) iteraties));
+	waarden.push_back (std::make_pair (std::string ("ns_per_op"),     per_op [per_op.size () / 2]));
+	waarden.push_back (std::make_pair (std::string ("ns_per_op_min"), per_op [0]));
+	waarden.push_back (std::make_pair (std::string ("allocs_per_op"), allocaties_per_op));
+	voegToe (suite, naam, waarden);
+}
+
+//	The suites of the Benchmark target:
+extern void microBenchmarks (Meting& meting, bool met_tekenen) ;		// Micro.cpp
+extern void macroBenchmarks (Meting& meting, bool met_tekenen) ;		// Macro.cpp
+
+#endif
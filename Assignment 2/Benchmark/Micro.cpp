@@ -0,0 +1,354 @@
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+
+/*
+	Micro benchmarks: ns per operation of the robot primitives on the headless Wereld, of the
+	world generators and the maze generators (Doolhof.h), of world loading, of the reachability
+	analysis (Bereik.h) and of the reference solutions (Oplosser.h), ns per instruction of the bytecode Machine, ns per action
+	of a compiled program with and without optimaliseer, of a loop that the Machine
+	fast-forwards and of a wall follower in a large maze, the throughput of the world pipeline
+	(Campagne.h), its queue and the copies of a world in an Arena, and (when a window is available) of the partial redraw done by every
+	primitive and the full redraw done by every generator.
+*/
+
+#include "Robot.h"
+#include "Bereik.h"
+#include "Campagne.h"
+#include "Doolhof.h"
+#include "Machine.h"
+#include "Meting.h"
+#include "Oplosser.h"
+#include "Optimalisatie.h"
+#include "Vertaler.h"
+#include "Wachtrij.h"
+
+using namespace std;
+
+static const char bench_wereld [] = "benchmark_world.txt";
+static const unsigned bench_seed  = 20061609;
+
+//	schrijfBenchWereld writes a small labyrinth in the format read by nieuweWereld.
+static void schrijfBenchWereld ()
+{
+	ofstream uit (bench_wereld);
+
+	const int hori = 6, verti = 8;
+	uit << 1 << ' ' << WereldHoogte-2 << ' ' << Oost << ' ' << WereldBreedte-2 << ' ' << 1 << ' '
+	    << hori << ' ' << verti << '\n';
+	for (int i = 0; i < hori; i++)
+		uit << 4 + i * 5 << ' ' << 4 + i * 4 << ' ' << 12 << '\n';
+	for (int i = 0; i < verti; i++)
+		uit << 5 + i * 5 << ' ' << 2 + (i % 3) * 6 << ' ' << 9 << '\n';
+}
+
+static void primitieven (Meting& meting)
+{
+	Wereld w;
+
+	w.plaatsRobot (1, 1, Oost);
+	meting.meet ("micro", "stap", [&] ()
+	{
+		if (w.muurVoor ())
+		{	w.linksom ();
+			w.linksom ();
+		}
+		w.stap ();
+	});
+
+	//	walking to the wall across the world, and after placing a wall in the row
+	w.plaatsRobot (1, 1, Oost);
+	meting.meet ("micro", "naarMuur", [&] ()
+	{
+		w.naarMuur ();
+		w.linksom ();
+		w.linksom ();
+	});
+	w.plaatsRobot (1, 1, Oost);
+	meting.meet ("micro", "naarMuur/na zetVeld", [&] ()
+	{
+		w.zetVeld (WereldBreedte / 2, 1, Muur);
+		w.zetVeld (WereldBreedte / 2, 1, Leeg);
+		w.naarMuur ();
+		w.linksom ();
+		w.linksom ();
+	});
+
+	w.plaatsRobot (1, 1, Oost);
+	meting.meet ("micro", "linksom",    [&] () { w.linksom (); });
+	meting.meet ("micro", "muurVoor",   [&] () { Meting::gebruik (w.muurVoor ()); });
+	meting.meet ("micro", "bovenopBal", [&] () { Meting::gebruik (w.bovenopBal ()); });
+	meting.meet ("micro", "legBal+pakBal", [&] ()
+	{
+		w.legBal ();
+		w.pakBal ();
+	});
+}
+
+static void generatoren (Meting& meting)
+{
+	Wereld w;
+
+	srand (bench_seed);
+	meting.meet ("micro", "reset",           [&] () { w.reset (); });
+	meting.meet ("micro", "maakGrot",        [&] () { w.maakGrot (); });
+	meting.meet ("micro", "maakBallenPad",   [&] () { w.maakBallenPad (); });
+	w.reset ();
+	meting.meet ("micro", "maakBallenSnoer", [&] () { w.maakBallenSnoer (); });
+	w.reset ();
+	meting.meet ("micro", "maakBallenChaos", [&] () { w.maakBallenChaos (); });
+	w.reset ();
+	meting.meet ("micro", "plaatsRechthoek", [&] () { w.plaatsRechthoek (5, 5, WereldBreedte / 2, WereldHoogte / 2); });
+	meting.meet ("micro", "maakMuur",        [&] () { w.maakMuur (3, 3, WereldBreedte - 8, true); });
+	meting.meet ("micro", "laad",            [&] () { w.laad (bench_wereld); });
+}
+
+//	doolhof measures the maze generators on a 1001 x 1001 world.
+static void doolhof (Meting& meting)
+{
+	Wereld w (1001, 1001);
+	unsigned long long zaad = bench_seed;
+	for (int soort = 0; soort < AantalDoolhofSoorten; soort++)
+	{
+		const string naam = string ("Doolhof/") + doolhofNaam ((DoolhofSoort) soort);
+		meting.meet ("micro", naam.c_str (), [&] () { maakDoolhof (w, (DoolhofSoort) soort, zaad++); });
+	}
+}
+
+//	analyse measures the hash, the regions and the distance field of a cave and of the labyrinth.
+static void analyse (Meting& meting)
+{
+	Wereld grot, labyrint;
+	srand (bench_seed);
+	grot.maakGrot ();
+	labyrint.laad (bench_wereld);
+
+	vector<int> afstand;
+	meting.meet ("micro", "Wereld::hash/grot",   [&] () { grot.zetVeld (1, 1, Leeg); Meting::gebruik (grot.hash ()); });
+	meting.meet ("micro", "Bereik/grot",         [&] () { Meting::gebruik (Bereik (grot).oplosbaar ()); });
+	meting.meet ("micro", "Bereik/labyrint",     [&] () { Meting::gebruik (Bereik (labyrint).oplosbaar ()); });
+	meting.meet ("micro", "afstanden/grot",      [&] () { Meting::gebruik (afstanden (grot, grot.x (), grot.y (), afstand)); });
+	meting.meet ("micro", "afstanden/labyrint",  [&] () { Meting::gebruik (afstanden (labyrint, labyrint.x (), labyrint.y (), afstand)); });
+}
+
+//	oplosser measures the reference solutions (Oplosser.h): a walk through the labyrinth, the
+//	exact search for six balls in it, and the nearest-target solutions of a ball path and a cave.
+static void oplosser (Meting& meting)
+{
+	Wereld labyrint, pad, grot, zes;
+	srand (bench_seed);
+	labyrint.laad (bench_wereld);
+	pad.maakBallenPad ();
+	grot.maakGrot ();
+	zes.laad (bench_wereld);
+	for (int i = 0; i < 6; i++)
+		zes.zetVeld (3 + i * 7, 3 + i * 3, Bal);
+
+	meting.meet ("micro", "Oplosser/naarVeld",   [&] () { Meting::gebruik (naarVeld (labyrint, WereldBreedte-2, 1).acties.size ()); });
+	meting.meet ("micro", "Oplosser/exact",      [&] () { Meting::gebruik (pakBallen (zes).acties.size ()); });
+	meting.meet ("micro", "Oplosser/pakBallen",  [&] () { Meting::gebruik (pakBallen (pad).acties.size ()); });
+	meting.meet ("micro", "Oplosser/vulGrot",    [&] () { Meting::gebruik (vulGrot (grot).acties.size ()); });
+}
+
+//	machine measures the bytecode interpreter on a program that follows the walls forever.
+static void machine (Meting& meting)
+{
+	Programma p;
+	Label lus = p.nieuwLabel (), vrij = p.nieuwLabel ();
+	p.plaats (lus);
+	p.muurVoor ().springAlsNiet (vrij).linksom ().spring (lus);
+	p.plaats (vrij);
+	p.stap ().spring (lus);
+	p.klaar ();
+
+	Wereld w;
+	w.plaatsRobot (1, 1, Oost);
+	Machine m (p, w);
+
+	const long long instructies = 1LL << 28;
+	m.voerUit (instructies / 16);		//	warm up
+
+	const double begin = Meting::nu_ns ();
+	m.voerUit (instructies);
+	const double ns = (Meting::nu_ns () - begin) / instructies;
+
+	Meting::Waarden waarden;
+	waarden.push_back (make_pair (string ("ns_per_instruction"),      ns));
+	waarden.push_back (make_pair (string ("instructions_per_second"), 1e9 / ns));
+	meting.voegToe ("micro", "machine", waarden);
+}
+
+//	optimalisatie measures a compiled program that walks up and down a corridor, before and
+//	after optimaliseer.
+static void optimalisatie (Meting& meting)
+{
+	const Programma gewoon = Vertaler::vertaal (
+		"repeat 200000 { repeat 40 { step } turn_left turn_left step step step step turn_right turn_right"
+		"                repeat 4 { step } turn_left turn_left repeat 40 { step } turn_left turn_left }", "corridor");
+	const Programma snel = optimaliseer (gewoon);
+
+	const Programma *const programmas [] = { &gewoon, &snel };
+	const char *const namen [] = { "machine/compiled", "machine/optimised" };
+	for (int i = 0; i < 2; i++)
+	{
+		Wereld w;
+		w.plaatsRobot (1, 1, Oost);
+		Machine m (*programmas [i], w);
+
+		const double begin = Meting::nu_ns ();
+		m.voerUit ();
+		const double ns = Meting::nu_ns () - begin;
+
+		Meting::Waarden waarden;
+		waarden.push_back (make_pair (string ("ns_per_action"), ns / m.acties ()));
+		waarden.push_back (make_pair (string ("instructions"),  (double) m.instructies ()));
+		waarden.push_back (make_pair (string ("code_length"),   (double) programmas [i] -> lengte ()));
+		meting.voegToe ("micro", namen [i], waarden);
+	}
+}
+
+//	doorspoelen measures loops that put and take balls up to the wall, which the Machine
+//	fast-forwards after Machine::Warm rounds.
+static void doorspoelen (Meting& meting)
+{
+	const Programma p = Vertaler::vertaal (
+		"repeat 100000 { while not in_front_of_wall { put_ball step } turn_left turn_left"
+		"                while not in_front_of_wall { step get_ball } turn_left turn_left }", "move_and_place");
+
+	Wereld w;
+	w.plaatsRobot (1, 1, Oost);
+	Machine m (p, w);
+
+	const double begin = Meting::nu_ns ();
+	m.voerUit ();
+	const double ns = Meting::nu_ns () - begin;
+
+	Meting::Waarden waarden;
+	waarden.push_back (make_pair (string ("ns_per_action"), ns / m.acties ()));
+	waarden.push_back (make_pair (string ("actions"),       (double) m.acties ()));
+	meting.voegToe ("micro", "machine/fast-forward", waarden);
+}
+
+//	doolhofVolgen measures a program that follows the left wall through a 2001 x 2001 maze
+//	until it finds the ball: millions of actions along one long path, generated without files.
+static void doolhofVolgen (Meting& meting)
+{
+	const Programma p = Vertaler::vertaal (
+		"while not on_ball { turn_left while in_front_of_wall { turn_right } step } get_ball", "muurvolger");
+
+	Wereld w (2001, 2001);
+	maakDoolhof (w, Backtracker, bench_seed);
+	Machine m (p, w);
+
+	const double begin = Meting::nu_ns ();
+	m.voerUit ();
+	const double ns = Meting::nu_ns () - begin;
+
+	Meting::Waarden waarden;
+	waarden.push_back (make_pair (string ("ns_per_action"), ns / m.acties ()));
+	waarden.push_back (make_pair (string ("actions"),       (double) m.acties ()));
+	meting.voegToe ("micro", "machine/doolhof", waarden);
+}
+
+//	pijplijn measures the queue on one thread, the copy of a world that a program runs on, on
+//	the heap and in an Arena, and a campaign of caves on which a program walks to the wall:
+//	with one generator and one evaluator thread the slower stage waits the least.
+static void pijplijn (Meting& meting)
+{
+	Wachtrij<int> rij (64);
+	int element = 1;
+	meting.meet ("micro", "Wachtrij/in+uit", [&] () { rij.probeerIn (element); rij.probeerUit (element); });
+
+	Wereld grot;
+	maakWereld (grot, GrotWereld, bench_seed);
+	meting.meet ("micro", "Wereld/kopie", [&] () { Wereld kopie (grot); Meting::gebruik (kopie.x ()); });
+	Arena arena;
+	meting.meet ("micro", "Wereld/kopie_in_arena", [&] ()
+	{
+		{
+			Wereld kopie (grot, &arena);
+			Meting::gebruik (kopie.x ());
+		}
+		arena.leeg ();
+	});
+
+	const Programma p = Vertaler::vertaal ("while not in_front_of_wall { step } turn_left", "naar de muur");
+	const Campagne campagne = { GrotWereld, 2000, bench_seed, WereldBreedte, WereldHoogte, 1, 1, 64 };
+	const Doorvoer doorvoer = voerCampagneUit (campagne, [&] (int, Wereld& wereld, Arena& arena)
+	{
+		Wereld kopie (wereld, &arena);
+		Machine m (p, kopie, &arena);
+		m.voerUit ();
+	});
+
+	Meting::Waarden waarden;
+	waarden.push_back (make_pair (string ("worlds_per_second"),  campagne.aantal / doorvoer.seconden));
+	waarden.push_back (make_pair (string ("generation_busy_ms"), doorvoer.generatie.bezig_ms));
+	waarden.push_back (make_pair (string ("generation_wait_ms"), doorvoer.generatie.wacht_ms));
+	waarden.push_back (make_pair (string ("evaluation_busy_ms"), doorvoer.evaluatie.bezig_ms));
+	waarden.push_back (make_pair (string ("evaluation_wait_ms"), doorvoer.evaluatie.wacht_ms));
+	waarden.push_back (make_pair (string ("queue_high_water"),   (double) doorvoer.hoogste_stand));
+	waarden.push_back (make_pair (string ("worlds_allocated"),   (double) doorvoer.nieuwe_werelden));
+	waarden.push_back (make_pair (string ("arena_allocations"),  (double) doorvoer.arena.allocaties));
+	waarden.push_back (make_pair (string ("arena_blocks"),       (double) doorvoer.arena.blokken));
+	waarden.push_back (make_pair (string ("arena_high_water"),   (double) doorvoer.arena.hoogste));
+	meting.voegToe ("micro", "campagne/grot", waarden);
+}
+
+static void tekenen (Meting& meting)
+{
+	rest (0);
+	nieuweWereld (bench_wereld);
+
+	const int x = wereldVanKarel ().x (), y = wereldVanKarel ().y ();
+	meting.meet ("render", "tekenWereldDeel/full",    [&] () { herteken_deel (0, 0, WereldBreedte - 1, WereldHoogte - 1); });
+	meting.meet ("render", "tekenWereldDeel/partial", [&] () { herteken_deel (x - 1, y - 1, x + 1, y + 1); });
+	meting.meet ("render", "nieuweWereld",            [&] () { nieuweWereld (bench_wereld); });
+
+	//	the walls of make_church with a frame per helper, and in one transaction
+	const auto kerk = [] ()
+	{
+		place_rectangle (5, 4, 20, 10);
+		place_rectangle (7, 14, 8, 5);
+		place_walls (11, 22, 4, false);
+		place_walls (10, 24, 2, true);
+		create_ball (5, WereldHoogte - 2);
+	};
+	meting.meet ("render", "kerk/per aanroep",        [&] () { kerk (); });
+	meting.meet ("render", "kerk/transactie",         [&] () { begin_edit (); kerk (); commit_edit (); });
+
+	//	a drawn primitive at rest (0): frames are capped at BeeldenPerSeconde, so this is mostly simulation
+	meting.meet ("render", "stap/getekend",           [&] () { if (muur_voor ()) linksom (); else stap (); });
+
+	//	a large world zoomed out until a pixel is a block of 4 x 4 fields (Dichtheid.h)
+	const int zoom_stappen = 7;
+	wereldVanKarel () = Wereld (800, 480);
+	for (int z = 0; z < zoom_stappen; z++)
+		zoom_out ();
+	bool bal = false;
+	meting.meet ("render", "dichtheid/full",          [&] () { herteken_deel (0, 0, 799, 479); });
+	meting.meet ("render", "dichtheid/partial",       [&] () { wereldVanKarel ().zetVeld (400, 240, (bal = !bal) ? Bal : Leeg); herteken_deel (399, 239, 401, 241); });
+	for (int z = 0; z < zoom_stappen; z++)
+		zoom_in ();
+	nieuweWereld (bench_wereld);
+}
+
+void microBenchmarks (Meting& meting, bool met_tekenen)
+{
+	schrijfBenchWereld ();
+
+	primitieven (meting);
+	generatoren (meting);
+	doolhof (meting);
+	analyse (meting);
+	oplosser (meting);
+	machine (meting);
+	optimalisatie (meting);
+	doorspoelen (meting);
+	doolhofVolgen (meting);
+	pijplijn (meting);
+	if (met_tekenen)
+		tekenen (meting);
+
+	remove (bench_wereld);
+}
@@ -0,0 +1,62 @@
+#include <algorithm>
+
+#include "Arena.h"
+
+using namespace std;
+
+Arena :: Arena (size_t blokgrootte)
+	: blokgrootte (max (blokgrootte, (size_t) 64)), blok (0), genomen (0)
+{
+	_tellers.allocaties	= 0;
+	_tellers.bytes		= 0;
+	_tellers.blokken	= 1;
+	_tellers.hoogste	= 0;
+	const Blok eerste = { new char [this -> blokgrootte], this -> blokgrootte };
+	blokken.push_back (eerste);
+	vrij = eerste.begin;
+	eind = eerste.begin + eerste.grootte;
+}
+
+Arena :: ~Arena ()
+{
+	for (size_t b = 0; b < blokken.size (); b++)
+		delete [] blokken [b].begin;
+}
+
+//	neem takes the bytes from the current block; when they do not fit it goes on with the next
+//	block that is large enough, and only when there is none it asks the heap for a new one.
+void* Arena :: neem (size_t bytes, size_t uitlijning)
+{
+	_tellers.allocaties++;
+	_tellers.bytes += bytes;
+
+	char *begin = (char*) (((size_t) vrij + uitlijning - 1) & ~(uitlijning - 1));
+	if (begin + bytes > eind)
+	{
+		genomen += vrij - blokken [blok].begin;
+		size_t b = blok + 1;
+		while (b < blokken.size () && blokken [b].grootte < bytes + uitlijning)
+			b++;
+		if (b == blokken.size ())
+		{
+			const size_t grootte = max (blokgrootte, bytes + uitlijning);
+			const Blok nieuw = { new char [grootte], grootte };
+			blokken.push_back (nieuw);
+			_tellers.blokken++;
+		}
+		blok = b;
+		eind = blokken [b].begin + blokken [b].grootte;
+		begin = (char*) (((size_t) blokken [b].begin + uitlijning - 1) & ~(uitlijning - 1));
+	}
+	vrij = begin + bytes;
+	_tellers.hoogste = max (_tellers.hoogste, genomen + (vrij - blokken [blok].begin));
+	return begin;
+}
+
+void Arena :: leeg ()
+{
+	blok	= 0;
+	vrij	= blokken [0].begin;
+	eind	= blokken [0].begin + blokken [0].grootte;
+	genomen	= 0;
+}
@@ -0,0 +1,97 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+/*
+	Arena gives out the memory for the data of one run, such as the copy of a world a program
+	runs on and the tables of its Machine. Every allocation takes the next bytes of the current
+	block; nothing is given back by itself, but leeg gives back everything at once, in O(1),
+	and keeps the blocks for the next run. After the first few runs an arena no longer asks the
+	heap for anything, so a long campaign has flat memory; and an arena belongs to one thread,
+	so the threads of a campaign do not contend for the heap.
+
+	Whatever was made in the arena must be gone before leeg: the memory is used again.
+
+	ArenaAllocator lets the standard containers use an arena. Without an arena (0) it uses the
+	heap, as std::allocator does; so a class can keep its data in ArenaVectors and only the
+	code that runs it decides where that data lives. A copy of a container is made on the heap,
+	unless an arena is given to its constructor, and assigning or swapping never moves the
+	arena of a container to another one: data only gets into an arena when asked.
+*/
+
+class Arena
+{
+public:
+	explicit Arena (size_t blokgrootte = 1 << 16);
+	~Arena ();
+
+	void*	neem		(size_t bytes, size_t uitlijning);
+	void	leeg		();						//	gives back everything that was taken since the last leeg
+
+	struct Tellers
+	{
+		long long	allocaties;				//	the calls of neem
+		long long	bytes;					//	taken by those calls
+		long long	blokken;				//	asked from the heap
+		size_t		hoogste;				//	the most bytes taken between two calls of leeg
+	} ;
+	const Tellers&	tellers	() const { return _tellers; }
+
+private:
+	Arena (const Arena&);
+	Arena& operator = (const Arena&);
+
+	struct Blok
+	{
+		char		*begin;
+		size_t		grootte;
+	} ;
+
+	const size_t		blokgrootte;
+	std::vector<Blok>	blokken;
+	size_t				blok;				//	the block neem takes from
+	char				*vrij;				//	its first free byte
+	char				*eind;
+	size_t				genomen;			//	since the last leeg, in the blocks before blok
+	Tellers				_tellers;
+} ;
+
+template <class T>
+class ArenaAllocator
+{
+public:
+	typedef T value_type;
+	typedef std::false_type propagate_on_container_copy_assignment;
+	typedef std::false_type propagate_on_container_move_assignment;
+	typedef std::false_type propagate_on_container_swap;
+
+	ArenaAllocator (Arena *arena = 0) : arena (arena) {}
+	template <class U>
+	ArenaAllocator (const ArenaAllocator<U>& ander) : arena (ander.arena) {}
+
+	T*		allocate	(size_t n)
+	{
+		if (arena != 0)
+			return static_cast<T*> (arena -> neem (n * sizeof (T), alignof (T)));
+		return static_cast<T*> (::operator new (n * sizeof (T)));
+	}
+	void	deallocate	(T *p, size_t) { if (arena == 0) ::operator delete (p); }
+
+	ArenaAllocator	select_on_container_copy_construction () const { return ArenaAllocator (); }
+
+	Arena	*arena;
+} ;
+
+template <class T, class U>
+inline bool operator == (const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) { return a.arena == b.arena; }
+template <class T, class U>
+inline bool operator != (const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) { return a.arena != b.arena; }
+
+template <class T>
+using ArenaVector = std::vector<T, ArenaAllocator<T> >;
+
+#endif
@@ -0,0 +1,266 @@
+#include <algorithm>
+
+/*
+	Vloed keeps sets of fields as rows of 64-bit words. A round grows the front by one step:
+	the new front is every free field next to the front that has not been reached yet. Left and
+	right neighbours are shifts within a row (with a carry between its words), the neighbours
+	above and below are the same word of the next and previous row. Only the rows around the
+	front are visited.
+
+	When only the region matters and not the distances, vul grows the front to its whole
+	region at once: every row is filled along its free runs with an occluded fill (six shifts
+	per word in each direction), and sweeps up and down spread the rows to their neighbours
+	until nothing changes.
+*/
+
+#include "Bereik.h"
+
+using namespace std;
+
+typedef unsigned long long Woord;
+
+class Vloed
+{
+public:
+	Vloed (const Wereld& wereld);
+
+	void	begin		(int x, int y);
+	bool	ronde		();
+	void	vul			();
+	int		merk		(vector<int>& waarden, int waarde) const;	//	sets the waarden of the front and counts its fields
+	int		telIn		(const Bitvlak& vlak) const;				//	the number of fields of the front in vlak
+	bool	volgendeVrij(int& x, int& y) const;							//	the first free field not reached, row by row
+
+private:
+	int				breedte, hoogte, woorden;
+	vector<Woord>	vrij, bereikt, front, nieuw;
+	int				laag, hoog;			//	the rows of the front; laag > hoog if it is empty
+} ;
+
+Vloed :: Vloed (const Wereld& wereld)
+	: breedte (wereld.breedte ()), hoogte (wereld.hoogte ()), woorden (wereld.muren ().woordenPerRij ()),
+	  vrij (woorden * hoogte), bereikt (woorden * hoogte, 0), front (woorden * hoogte, 0), nieuw (woorden * hoogte, 0),
+	  laag (0), hoog (-1)
+{
+	const Woord laatste = (breedte % 64 == 0) ? ~0ULL : (1ULL << (breedte % 64)) - 1;
+	for (int y = 0; y < hoogte; y++)
+	{
+		const Woord *muren = wereld.muren ().rij (y);
+		for (int k = 0; k < woorden; k++)
+			vrij [y * woorden + k] = ~muren [k] & (k == woorden - 1 ? laatste : ~0ULL);
+	}
+}
+
+void Vloed :: begin (int x, int y)
+{
+	for (int r = laag; r <= hoog; r++)
+		fill (&front [r * woorden], &front [r * woorden] + woorden, 0);
+	const Woord bit = 1ULL << (x & 63);
+	front [y * woorden + (x >> 6)] = bit;
+	bereikt [y * woorden + (x >> 6)] |= bit;
+	laag = hoog = y;
+}
+
+bool Vloed :: ronde ()
+{
+	const int van = max (laag - 1, 0), tot = min (hoog + 1, hoogte - 1);
+	int nieuw_laag = hoogte, nieuw_hoog = -1;
+	for (int y = van; y <= tot; y++)
+	{
+		const Woord *f = &front [y * woorden];
+		for (int k = 0; k < woorden; k++)
+		{
+			Woord groei = (f [k] << 1) | (f [k] >> 1);
+			if (k > 0)
+				groei |= f [k-1] >> 63;
+			if (k + 1 < woorden)
+				groei |= f [k+1] << 63;
+			if (y > 0)
+				groei |= f [k - woorden];
+			if (y + 1 < hoogte)
+				groei |= f [k + woorden];
+			groei &= vrij [y * woorden + k] & ~bereikt [y * woorden + k];
+
+			nieuw [y * woorden + k] = groei;
+			if (groei != 0)
+			{
+				nieuw_laag = min (nieuw_laag, y);
+				nieuw_hoog = y;
+			}
+		}
+	}
+
+	for (int y = van; y <= tot; y++)
+		for (int k = 0; k < woorden; k++)
+		{
+			front [y * woorden + k]    = 0;
+			bereikt [y * woorden + k] |= nieuw [y * woorden + k];
+		}
+	front.swap (nieuw);
+	laag = nieuw_laag;
+	hoog = nieuw_hoog;
+	return laag <= hoog;
+}
+
+//	spreid fills the free runs of a row that contain a field of the row r; true if r changed.
+static bool spreid (Woord *r, const Woord *vrij, int woorden)
+{
+	bool veranderd = false;
+	for (bool verder = true; verder; )
+	{
+		verder = false;
+		for (int k = 0; k < woorden; k++)
+		{
+			const Woord m = vrij [k];
+			Woord w = r [k], v = m, a = m;
+			if (k > 0 && (r [k-1] >> 63))
+				w |= m & 1;
+			if (k + 1 < woorden && (r [k+1] & 1))
+				w |= m & (1ULL << 63);
+			for (int n = 1; n < 64; n *= 2)
+			{
+				w |= v & (w << n);
+				w |= a & (w >> n);
+				v &= v << n;
+				a &= a >> n;
+			}
+			if (w != r [k])
+			{
+				r [k] = w;
+				veranderd = verder = true;
+			}
+		}
+	}
+	return veranderd;
+}
+
+void Vloed :: vul ()
+{
+	vector<Woord>& regio = front;
+	spreid (&regio [laag * woorden], &vrij [laag * woorden], woorden);
+
+	for (bool veranderd = true; veranderd; )
+	{
+		veranderd = false;
+		for (int richting = 1; richting >= -1; richting -= 2)
+			for (int y = (richting > 0) ? 1 : hoogte - 2; y >= 0 && y < hoogte; y += richting)
+			{
+				Woord *rij = &regio [y * woorden];
+				const Woord *buur = &regio [(y - richting) * woorden];
+				bool groei = false;
+				for (int k = 0; k < woorden; k++)
+				{
+					const Woord erbij = buur [k] & vrij [y * woorden + k] & ~rij [k];
+					if (erbij != 0)
+					{
+						rij [k] |= erbij;
+						groei = true;
+					}
+				}
+				if (groei)
+				{
+					spreid (rij, &vrij [y * woorden], woorden);
+					veranderd = true;
+				}
+			}
+	}
+
+	laag = hoogte;
+	hoog = -1;
+	for (int y = 0; y < hoogte; y++)
+		for (int k = 0; k < woorden; k++)
+		{
+			bereikt [y * woorden + k] |= regio [y * woorden + k];
+			if (regio [y * woorden + k] != 0)
+			{
+				laag = min (laag, y);
+				hoog = y;
+			}
+		}
+}
+
+int Vloed :: merk (vector<int>& waarden, int waarde) const
+{
+	int aantal = 0;
+	for (int y = laag; y <= hoog; y++)
+		for (int k = 0; k < woorden; k++)
+			for (Woord w = front [y * woorden + k]; w != 0; w &= w - 1)
+			{
+				waarden [(k * 64 + laagsteBit (w)) * hoogte + y] = waarde;
+				aantal++;
+			}
+	return aantal;
+}
+
+int Vloed :: telIn (const Bitvlak& vlak) const
+{
+	int aantal = 0;
+	for (int y = laag; y <= hoog; y++)
+	{
+		const Woord *bits = vlak.rij (y);
+		for (int k = 0; k < woorden; k++)
+			aantal += telBits (front [y * woorden + k] & bits [k]);
+	}
+	return aantal;
+}
+
+bool Vloed :: volgendeVrij (int& x, int& y) const
+{
+	for (; y < hoogte; y++)
+		for (int k = 0; k < woorden; k++)
+		{
+			const Woord over = vrij [y * woorden + k] & ~bereikt [y * woorden + k];
+			if (over != 0)
+			{
+				x = k * 64 + laagsteBit (over);
+				return true;
+			}
+		}
+	return false;
+}
+
+Bereik :: Bereik (const Wereld& wereld)
+	: hoogte (wereld.hoogte ()), ballen (0), karel (-1), nummers (wereld.breedte () * wereld.hoogte (), -1)
+{
+	Vloed vloed (wereld);
+	int x = 0, y = 0;
+	while (vloed.volgendeVrij (x, y))
+	{
+		const int nummer = (int) gebieden.size ();
+		Gebied gebied = { 0, 0, x, y };
+		vloed.begin (x, y);
+		vloed.vul ();
+		gebied.velden = vloed.merk (nummers, nummer);
+		gebied.ballen = vloed.telIn (wereld.ballen ());
+		gebieden.push_back (gebied);
+		ballen += gebied.ballen;
+	}
+	karel = gebied (wereld.x (), wereld.y ());
+}
+
+bool Bereik :: samen (int x1, int y1, int x2, int y2) const
+{
+	const int gebied1 = gebied (x1, y1);
+	return gebied1 >= 0 && gebied1 == gebied (x2, y2);
+}
+
+//	oplosbaar: Charles stands on a free field and can reach every ball.
+bool Bereik :: oplosbaar () const
+{
+	return karel >= 0 && gebieden [karel].ballen == ballen;
+}
+
+int afstanden (const Wereld& wereld, int x, int y, vector<int>& afstand)
+{
+	afstand.assign (wereld.breedte () * wereld.hoogte (), -1);
+	if (wereld.veld (x, y) == Muur)
+		return -1;
+
+	Vloed vloed (wereld);
+	vloed.begin (x, y);
+	int stappen = 0;
+	do
+		vloed.merk (afstand, stappen++);
+	while (vloed.ronde ());
+	return stappen - 1;
+}
@@ -0,0 +1,54 @@
+#ifndef BEREIK_H
+#define BEREIK_H
+
+#include <vector>
+
+#include "Wereld.h"
+
+/*
+	Bereik analyses which fields of a world Charles can reach. The free fields (no wall) form
+	regions in which he can step from every field to every other one; Bereik numbers them and
+	counts their fields and balls. A world can only be solved by a program that must visit
+	every ball if all balls lie in the region of Charles (oplosbaar).
+
+	afstanden gives the number of steps from a field to every other one (a distance field),
+	or -1 for walls and fields that can not be reached.
+
+	Both grow sets of fields over the rows of the wall Bitvlak of the world, 64 fields per
+	word operation: afstanden one step of Charles at a time, Bereik a whole region at once.
+	The regions of a 50 x 30 world are found in a few microseconds, so that generated worlds
+	can be checked by the million. The results are in the order of the fields of the world
+	(x * hoogte + y).
+*/
+
+struct Gebied
+{
+	int		velden;				//	the number of fields
+	int		ballen;				//	the number of balls on them
+	int		x, y;				//	its first field, row by row from the bottom
+} ;
+
+class Bereik
+{
+public:
+	explicit		Bereik		(const Wereld& wereld);
+
+	int				aantal		() const { return (int) gebieden.size (); }
+	const Gebied&	operator []	(int i) const { return gebieden [i]; }
+	int				gebied		(int x, int y) const { return nummers [x * hoogte + y]; }	//	-1 for a wall
+	bool			samen		(int x1, int y1, int x2, int y2) const;
+
+	int				vanKarel	() const { return karel; }	//	the region of Charles; -1 if he stands on a wall
+	bool			oplosbaar	() const;
+
+private:
+	int					hoogte;
+	int					ballen;
+	int					karel;
+	std::vector<int>	nummers;
+	std::vector<Gebied>	gebieden;
+} ;
+
+int afstanden (const Wereld& wereld, int x, int y, std::vector<int>& afstand);	//	returns the largest distance, -1 if (x,y) is a wall
+
+#endif
@@ -0,0 +1,192 @@
+#include <algorithm>
+
+#include "Bitvlak.h"
+
+using namespace std;
+
+typedef unsigned long long Woord;
+
+static const Woord Alles = ~0ULL;
+
+//	masker has the bits van <= i < tot of word nummer set.
+static Woord masker (int nummer, int van, int tot)
+{
+	const int laag = max (van - nummer * 64, 0), hoog = min (tot - nummer * 64, 64);
+	const Woord boven = (hoog == 64) ? Alles : ((1ULL << hoog) - 1);
+	return boven & (Alles << laag);
+}
+
+//	eerste and laatste search the bits van <= i < tot of a row or column for bit b.
+static int eerste (const Woord *woorden, int van, int tot, bool b)
+{
+	if (van >= tot)
+		return tot;
+	for (int n = van >> 6; n <= (tot - 1) >> 6; n++)
+	{
+		const Woord w = (b ? woorden [n] : ~woorden [n]) & masker (n, van, tot);
+		if (w != 0)
+			return n * 64 + laagsteBit (w);
+	}
+	return tot;
+}
+
+static int laatste (const Woord *woorden, int van, int tot, bool b)
+{
+	if (van >= tot)
+		return van - 1;
+	for (int n = (tot - 1) >> 6; n >= van >> 6; n--)
+	{
+		const Woord w = (b ? woorden [n] : ~woorden [n]) & masker (n, van, tot);
+		if (w != 0)
+			return n * 64 + hoogsteBit (w);
+	}
+	return van - 1;
+}
+
+static void zetReeks (Woord *woorden, int van, int tot, bool b)
+{
+	for (int n = van >> 6; van < tot && n <= (tot - 1) >> 6; n++)
+		if (b)
+			woorden [n] |= masker (n, van, tot);
+		else
+			woorden [n] &= ~masker (n, van, tot);
+}
+
+Bitvlak :: Bitvlak (int breedte, int hoogte, Arena *arena)
+	: rij_woorden ((breedte + 63) / 64), kolom_woorden ((hoogte + 63) / 64),
+	  rijen (rij_woorden * hoogte, 0, arena), kolommen (kolom_woorden * breedte, 0, arena)
+{
+}
+
+Bitvlak :: Bitvlak (const Bitvlak& ander, Arena *arena)
+	: rij_woorden (ander.rij_woorden), kolom_woorden (ander.kolom_woorden),
+	  rijen (ander.rijen, arena), kolommen (ander.kolommen, arena)
+{
+}
+
+void Bitvlak :: zet (int x, int y, bool b)
+{
+	Woord& rij   = rijen [y * rij_woorden + (x >> 6)];
+	Woord& kolom = kolommen [x * kolom_woorden + (y >> 6)];
+	if (b)
+	{
+		rij   |= 1ULL << (x & 63);
+		kolom |= 1ULL << (y & 63);
+	}
+	else
+	{
+		rij   &= ~(1ULL << (x & 63));
+		kolom &= ~(1ULL << (y & 63));
+	}
+}
+
+void Bitvlak :: wis ()
+{
+	fill (rijen.begin (), rijen.end (), 0);
+	fill (kolommen.begin (), kolommen.end (), 0);
+}
+
+int Bitvlak :: eersteInRij (int y, int lx, int rx, bool b) const
+{
+	return eerste (&rijen [y * rij_woorden], lx, rx, b);
+}
+
+int Bitvlak :: laatsteInRij (int y, int lx, int rx, bool b) const
+{
+	return laatste (&rijen [y * rij_woorden], lx, rx, b);
+}
+
+int Bitvlak :: eersteInKolom (int x, int ly, int ry, bool b) const
+{
+	return eerste (&kolommen [x * kolom_woorden], ly, ry, b);
+}
+
+int Bitvlak :: laatsteInKolom (int x, int ly, int ry, bool b) const
+{
+	return laatste (&kolommen [x * kolom_woorden], ly, ry, b);
+}
+
+//	transponeer mirrors a block of 64 x 64 bits in its diagonal: bit j of word i becomes bit i
+//	of word j. The two off-diagonal quarters are swapped, then the quarters of each quarter,
+//	and so on; every round is a shift and a mask of 32 pairs of words.
+static void transponeer (Woord a [64])
+{
+	Woord m = 0x00000000FFFFFFFFULL;
+	for (int j = 32; j != 0; j >>= 1, m ^= m << j)
+		for (int k = 0; k < 64; k = (k + j + 1) & ~j)
+		{
+			const Woord t = ((a [k] >> j) ^ a [k + j]) & m;
+			a [k]	  ^= t << j;
+			a [k + j] ^= t;
+		}
+}
+
+//	laadKolommen takes the columns as they are, and then builds the row words of the columns
+//	again, a block of 64 x 64 fields at a time.
+void Bitvlak :: laadKolommen (int x, int aantal, const Woord woorden [])
+{
+	copy (woorden, woorden + aantal * kolom_woorden, &kolommen [x * kolom_woorden]);
+
+	const int breedte = (int) (kolommen.size () / max (kolom_woorden, 1)), hoogte = (int) (rijen.size () / max (rij_woorden, 1));
+	for (int k = x >> 6; k <= (x + aantal - 1) >> 6; k++)
+		for (int n = 0; n < kolom_woorden; n++)
+		{
+			Woord blok [64];
+			for (int c = 0; c < 64; c++)
+				blok [c] = (k * 64 + c < breedte) ? kolommen [(k * 64 + c) * kolom_woorden + n] : 0;
+			transponeer (blok);
+			for (int r = 0; r < 64 && n * 64 + r < hoogte; r++)
+				rijen [(n * 64 + r) * rij_woorden + k] = blok [r];
+		}
+}
+
+//	zetReeksen sets the span van <= i < tot in 'aantal' rows or columns of 'stap' words each.
+//	When the span lies within one word, as for the single field of a row in the column plane,
+//	its mask is computed once.
+static void zetReeksen (Woord *woorden, int stap, int aantal, int van, int tot, bool b)
+{
+	const int n = van >> 6;
+	if (n != (tot - 1) >> 6)
+	{
+		for (int i = 0; i < aantal; i++)
+			zetReeks (woorden + i * stap, van, tot, b);
+		return;
+	}
+
+	const Woord m = masker (n, van, tot);
+	Woord *w = woorden + n;
+	if (b)
+		for (int i = 0; i < aantal; i++, w += stap)
+			*w |= m;
+	else
+		for (int i = 0; i < aantal; i++, w += stap)
+			*w &= ~m;
+}
+
+//	zetRechthoek sets a span in every row and in every column of the rectangle.
+void Bitvlak :: zetRechthoek (int lx, int ly, int rx, int ry, bool b)
+{
+	if (lx >= rx || ly >= ry)
+		return;
+	zetReeksen (&rijen [ly * rij_woorden],       rij_woorden,   ry - ly, lx, rx, b);
+	zetReeksen (&kolommen [lx * kolom_woorden], kolom_woorden, rx - lx, ly, ry, b);
+}
+
+//	ergensIn looks along the shorter side of the rectangle: every row or column of the other
+//	side is then a few words.
+bool Bitvlak :: ergensIn (int lx, int ly, int rx, int ry, bool b) const
+{
+	if (lx >= rx || ly >= ry)
+		return false;
+	if (rx - lx <= ry - ly)
+	{
+		for (int x = lx; x < rx; x++)
+			if (eerste (&kolommen [x * kolom_woorden], ly, ry, b) < ry)
+				return true;
+	}
+	else
+		for (int y = ly; y < ry; y++)
+			if (eerste (&rijen [y * rij_woorden], lx, rx, b) < rx)
+				return true;
+	return false;
+}
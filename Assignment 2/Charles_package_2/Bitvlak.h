@@ -0,0 +1,92 @@
+#ifndef BITVLAK_H
+#define BITVLAK_H
+
+#include "Arena.h"
+
+/*
+	Bitvlak is a plane of one bit per field, such as 'this field has a ball'. It is kept twice,
+	once row by row and once column by column, so that a span of fields in a row as well as in
+	a column is a few 64-bit words: finding the first field of a span with or without the bit,
+	or setting a whole span, costs one operation per 64 fields instead of one per field.
+
+	Spans are half-open: the fields lx <= x < rx of row y, or ly <= y < ry of column x.
+	A rectangle is half-open in both directions.
+	The first / last functions return the end of the span (rx or ry) / one before its start
+	(lx - 1 or ly - 1) when no field of the span has bit b.
+
+	rij gives the words of a row for word-parallel algorithms: bit x & 63 of word x >> 6 is
+	field x; the bits beyond the width of the world are 0. kolom does the same for a column.
+
+	The words are kept in the Arena (Arena.h) that is given to the constructor, or on the heap.
+*/
+
+//	The index of the lowest and highest set bit of a word that is not 0, and the number of set bits.
+inline int laagsteBit (unsigned long long w)
+{
+#if defined(__GNUC__)
+	return __builtin_ctzll (w);
+#else
+	int i = 0;
+	for (; !(w & 1); w >>= 1)
+		i++;
+	return i;
+#endif
+}
+
+inline int hoogsteBit (unsigned long long w)
+{
+#if defined(__GNUC__)
+	return 63 - __builtin_clzll (w);
+#else
+	int i = 63;
+	for (; !(w >> 63); w <<= 1)
+		i--;
+	return i;
+#endif
+}
+
+inline int telBits (unsigned long long w)
+{
+#if defined(__GNUC__)
+	return __builtin_popcountll (w);
+#else
+	int n = 0;
+	for (; w != 0; w &= w - 1)
+		n++;
+	return n;
+#endif
+}
+
+class Bitvlak
+{
+public:
+	Bitvlak (int breedte = 0, int hoogte = 0, Arena *arena = 0);
+	Bitvlak (const Bitvlak& ander, Arena *arena);
+
+	bool	bit				(int x, int y) const { return (rijen [y * rij_woorden + (x >> 6)] >> (x & 63)) & 1; }
+	void	zet				(int x, int y, bool b);
+	void	wis				();
+
+	int		woordenPerRij	() const { return rij_woorden; }
+	int		woordenPerKolom	() const { return kolom_woorden; }
+	const unsigned long long *rij	(int y) const { return &rijen [y * rij_woorden]; }
+	const unsigned long long *kolom	(int x) const { return &kolommen [x * kolom_woorden]; }
+	void	laadKolommen	(int x, int aantal, const unsigned long long woorden []);	//	replaces the columns x .. x + aantal - 1
+
+	int		eersteInRij		(int y, int lx, int rx, bool b) const;
+	int		laatsteInRij	(int y, int lx, int rx, bool b) const;
+	int		eersteInKolom	(int x, int ly, int ry, bool b) const;
+	int		laatsteInKolom	(int x, int ly, int ry, bool b) const;
+	void	zetRechthoek	(int lx, int ly, int rx, int ry, bool b);
+	bool	ergensIn		(int lx, int ly, int rx, int ry, bool b) const;	//	some field of the rectangle has bit b
+	void	zetRij			(int y, int lx, int rx, bool b) { zetRechthoek (lx, y, rx, y + 1, b); }
+	void	zetKolom		(int x, int ly, int ry, bool b) { zetRechthoek (x, ly, x + 1, ry, b); }
+
+private:
+	int									rij_woorden;	// words per row
+	int									kolom_woorden;	// words per column
+	ArenaVector<unsigned long long>		rijen;			// row y starts at word y * rij_woorden
+	ArenaVector<unsigned long long>		kolommen;		// column x starts at word x * kolom_woorden
+} ;
+
+#endif
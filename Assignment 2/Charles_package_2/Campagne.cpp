@@ -0,0 +1,165 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+/*
+	The generators take the number of the next world from a shared counter, so a slow world
+	does not hold up the others. The evaluators stop when every generator has finished and
+	the queue is empty; the generators publish that they have finished (release) after their
+	last world is in the queue, so an evaluator that sees it (acquire) and then finds the
+	queue empty has seen every world.
+
+	A thread that waits yields its processor: a waiting generator lets an evaluator make room,
+	and the other way around, also when there are fewer processors than threads.
+
+	The evaluated worlds go back to the generators through a second Wachtrij. It has room for
+	every world there can be at once, so putting a world back never fails; a generator only
+	makes a new world while the first worlds are still on their way.
+*/
+
+#include "Campagne.h"
+#include "Doolhof.h"
+#include "Toeval.h"
+#include "Wachtrij.h"
+
+using namespace std;
+
+static double nu_ms ()
+{
+	return chrono::duration_cast<chrono::nanoseconds> (chrono::steady_clock::now ().time_since_epoch ()).count () / 1e6;
+}
+
+//	maakWereld also makes a world in a world that was used before: reset gives Charles the
+//	direction of a new world, which maakGrot and maakBallenPad keep.
+void maakWereld (Wereld& wereld, WereldSoort soort, unsigned long long zaad)
+{
+	EigenToeval toeval (zaad);
+	switch (soort)
+	{
+		case GrotWereld:	wereld.reset (); wereld.maakGrot ();				break;
+		case ChaosWereld:	wereld.reset (); wereld.maakBallenChaos ();			break;
+		case PadWereld:		wereld.reset (); wereld.maakBallenPad ();			break;
+		default:			maakDoolhof (wereld, Backtracker, zaad);			break;
+	}
+}
+
+const char *wereldNaam (WereldSoort soort)
+{
+	switch (soort)
+	{
+		case GrotWereld:	return "cave";
+		case ChaosWereld:	return "chaos";
+		case PadWereld:		return "path";
+		case DoolhofWereld:	return "maze";
+		default:			return "unknown";
+	}
+}
+
+struct Stuk
+{
+	int					nummer;
+	unique_ptr<Wereld>	wereld;
+} ;
+
+static void telInRij (atomic<int>& in_rij, atomic<int>& hoogste, int verschil)
+{
+	const int stand = in_rij.fetch_add (verschil, memory_order_relaxed) + verschil;
+	int oud = hoogste.load (memory_order_relaxed);
+	while (stand > oud && !hoogste.compare_exchange_weak (oud, stand, memory_order_relaxed))
+		;
+}
+
+Doorvoer voerCampagneUit (const Campagne& campagne, const Evaluatie& evalueer)
+{
+	Wachtrij<Stuk>	rij (campagne.capaciteit);
+	Wachtrij<unique_ptr<Wereld> >	gebruikt (rij.capaciteit () + campagne.generatoren + campagne.evaluatoren);	//	room for every world
+	atomic<int>		volgende (0), klaar (0), in_rij (0), hoogste (0), nieuw (0);
+	vector<Fase>	generatie (campagne.generatoren), evaluatie (campagne.evaluatoren);
+	vector<Arena::Tellers>	tellers (campagne.evaluatoren);
+
+	const auto genereer = [&] (Fase& fase)
+	{
+		fase = Fase ();
+		for (int nummer; (nummer = volgende.fetch_add (1, memory_order_relaxed)) < campagne.aantal; )
+		{
+			const double begin = nu_ms ();
+			Stuk stuk;
+			stuk.nummer = nummer;
+			if (!gebruikt.probeerUit (stuk.wereld))
+			{
+				stuk.wereld.reset (new Wereld (campagne.breedte, campagne.hoogte));
+				nieuw.fetch_add (1, memory_order_relaxed);
+			}
+			maakWereld (*stuk.wereld, campagne.soort, campagne.zaad + nummer);
+			const double gemaakt = nu_ms ();
+
+			while (!rij.probeerIn (stuk))
+				this_thread::yield ();
+			telInRij (in_rij, hoogste, 1);
+			fase.werelden++;
+			fase.bezig_ms += gemaakt - begin;
+			fase.wacht_ms += nu_ms () - gemaakt;
+		}
+		klaar.fetch_add (1, memory_order_release);
+	};
+
+	const auto evalueerAlles = [&] (Fase& fase, Arena::Tellers& arena_tellers)
+	{
+		fase = Fase ();
+		Arena arena;
+		double wacht_begin = nu_ms ();
+		for (;;)
+		{
+			const bool alles_gemaakt = klaar.load (memory_order_acquire) == campagne.generatoren;
+			Stuk stuk;
+			if (rij.probeerUit (stuk))
+			{
+				telInRij (in_rij, hoogste, -1);
+				const double begin = nu_ms ();
+				fase.wacht_ms += begin - wacht_begin;
+				evalueer (stuk.nummer, *stuk.wereld, arena);
+				arena.leeg ();
+				gebruikt.probeerIn (stuk.wereld);
+				fase.werelden++;
+				wacht_begin = nu_ms ();
+				fase.bezig_ms += wacht_begin - begin;
+			}
+			else if (alles_gemaakt)
+				break;
+			else
+				this_thread::yield ();
+		}
+		arena_tellers = arena.tellers ();
+	};
+
+	const double begin = nu_ms ();
+	vector<thread> threads;
+	for (int g = 0; g < campagne.generatoren; g++)
+		threads.push_back (thread (genereer, ref (generatie [g])));
+	for (int e = 0; e < campagne.evaluatoren; e++)
+		threads.push_back (thread (evalueerAlles, ref (evaluatie [e]), ref (tellers [e])));
+	for (size_t t = 0; t < threads.size (); t++)
+		threads [t].join ();
+
+	Doorvoer doorvoer = { Fase (), Fase (), (nu_ms () - begin) / 1000, hoogste.load (), nieuw.load (), Arena::Tellers () };
+	for (size_t g = 0; g < generatie.size (); g++)
+	{
+		doorvoer.generatie.werelden += generatie [g].werelden;
+		doorvoer.generatie.bezig_ms += generatie [g].bezig_ms;
+		doorvoer.generatie.wacht_ms += generatie [g].wacht_ms;
+	}
+	for (size_t e = 0; e < evaluatie.size (); e++)
+	{
+		doorvoer.evaluatie.werelden += evaluatie [e].werelden;
+		doorvoer.evaluatie.bezig_ms += evaluatie [e].bezig_ms;
+		doorvoer.evaluatie.wacht_ms += evaluatie [e].wacht_ms;
+		doorvoer.arena.allocaties	+= tellers [e].allocaties;
+		doorvoer.arena.bytes		+= tellers [e].bytes;
+		doorvoer.arena.blokken		+= tellers [e].blokken;
+		doorvoer.arena.hoogste		 = max (doorvoer.arena.hoogste, tellers [e].hoogste);
+	}
+	return doorvoer;
+}
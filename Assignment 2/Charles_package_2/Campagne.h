@@ -0,0 +1,76 @@
+#ifndef CAMPAGNE_H
+#define CAMPAGNE_H
+
+#include <functional>
+
+#include "Arena.h"
+#include "Wereld.h"
+
+/*
+	Campagne evaluates many generated worlds in a pipeline. Generator threads make the worlds
+	from their seeds and put them into a Wachtrij (Wachtrij.h); evaluator threads take them
+	out and call evalueer on them. When the queue is full the generators wait (back-pressure),
+	so that at most capaciteit worlds, plus one per thread, exist at a time; when it is empty
+	the evaluators wait. Doorvoer tells per stage how many worlds went through it, how long
+	its threads were busy and how long they waited: a stage that waits a lot has more threads
+	than it needs, and the other stage is the one to give more.
+
+	World i of a campaign is generated from seed zaad + i with its own Toeval (Toeval.h), so
+	it is the same world whichever thread makes it and however many threads there are. A
+	world belongs to one thread at a time: Wereld fills its caches even in const functions,
+	so two threads must never use the same Wereld.
+
+	evalueer is called from several threads at once, each time with another world; it must
+	only change what belongs to that world (such as element nummer of a vector), and must not
+	throw. The world is used again for a later world afterwards, so evalueer may change it.
+
+	Memory is used again as well, so that a long campaign does not grow and its threads do
+	not contend for the heap. An evaluated world goes back to the generators, which make the
+	next world in it. Every evaluator thread has an Arena (Arena.h) that it passes to
+	evalueer, for the data of the runs on that world (the copies of the world, the machines);
+	the arena is emptied after every world, so that data must not outlive evalueer.
+
+	The worlds are at least MinimaleZijde x MinimaleZijde fields, the smallest size for which
+	every kind can be generated.
+*/
+
+enum WereldSoort { GrotWereld, ChaosWereld, PadWereld, DoolhofWereld, AantalWereldSoorten };
+
+enum { MinimaleZijde = 20 };
+
+void		maakWereld		(Wereld& wereld, WereldSoort soort, unsigned long long zaad);
+const char*	wereldNaam		(WereldSoort soort);		//	"cave", "chaos", "path" or "maze"
+
+struct Campagne
+{
+	WereldSoort			soort;
+	int					aantal;				//	the number of worlds
+	unsigned long long	zaad;				//	of the first world
+	int					breedte, hoogte;
+	int					generatoren;		//	the number of generator threads
+	int					evaluatoren;		//	the number of evaluator threads
+	int					capaciteit;			//	the number of worlds the queue can hold
+} ;
+
+struct Fase
+{
+	long long	werelden;
+	double		bezig_ms;		//	summed over the threads of the stage
+	double		wacht_ms;		//	generators: for room in the queue; evaluators: for a world
+} ;
+
+struct Doorvoer
+{
+	Fase		generatie;
+	Fase		evaluatie;
+	double		seconden;		//	of the whole campaign
+	int			hoogste_stand;	//	the largest number of worlds in the queue at once
+	int			nieuwe_werelden;	//	the worlds made on the heap; the others were used again
+	Arena::Tellers	arena;		//	of the evaluator threads together; hoogste of the largest
+} ;
+
+typedef std::function<void (int nummer, Wereld& wereld, Arena& arena)> Evaluatie;
+
+Doorvoer	voerCampagneUit	(const Campagne& campagne, const Evaluatie& evalueer);
+
+#endif
@@ -17,11 +17,13 @@ void make_church ()
     const int street = 2 + rand () % (WereldBreedte / 5) ;
     const int width  = 3 + rand () % (WereldBreedte / 2) ;
     const int height = 2 + rand () % (WereldHoogte / 3) ;
+    begin_edit () ;
     place_rectangle (street,lane,width,height) ;
     place_rectangle (street + 2,lane + height, 2 + width / 3, 2 + height / 3) ;
     place_walls (street + 3 + width / 6,lane + height + height / 3 + 3,4,false) ;
     place_walls (street + 2 + width / 6,lane + height + height / 3 + 5,2,true) ;
     create_ball (street, WereldHoogte - 2) ;
+    commit_edit () ;
 }
 
 
@@ -164,10 +166,7 @@ void move_and_place()
 void just_move()
 {
   //charles is just moving
-  while (!in_front_of_wall())
-  {
-    step();
-  }
+  walk_to_wall();
 }
 
 void compact()
@@ -176,7 +175,7 @@ void compact()
   if (in_front_of_wall())
   {
     //place final ball and do a 180
-    place_ball();
+    put_ball();
     turn_left();
     turn_left();
     //get back
@@ -233,21 +232,6 @@ void kerk_zoeken(){
         }
 }
 
-void rondje_kerk(){
-    //is muur rechts van karel?
-
-
-}
-
-void kerk_zoeken(){
-    while (!in_front_of_wall()){
-            step();
-        }
-        if (in_front_of_wall()){
-            stop();
-        }
-}
-
 void rondje_kerk(){
     //is muur rechts van karel?
 
@@ -282,16 +266,20 @@ void Bonus(){
 // =========================================================================
 
 
-void quick  () { rest(    1); };
+void quick  () { rest(    0); };
 void normal () { rest(0.5); };
 void slow   () { rest(  250); };
 void very_slow  () { rest( 1000); };
 
+#ifndef KAREL_BENCHMARK     // the Benchmark target has its own main and only uses the routines above
 int WINAPI WinMain (HINSTANCE hInstance, HINSTANCE hPrevInstance, PSTR szCmdLine, int iCmdShow)
 {
     Menu charles_menu ((char*)"Charles") ;
-    charles_menu.add ((char*)"Clean", reset)
-                .add ((char*)"Stop",  stop) ;
+    charles_menu.add ((char*)"Clean", reset, 'N')
+                .add ((char*)"Stop",  stop)
+                .add ((char*)"Statistics", show_statistics, 'I')
+                .add ((char*)"Record trace", record_trace, 'T')
+                .add ((char*)"Campaign overview...", campaign_overview) ;
 
 	Menu a1_menu ((char*)"Assignment 2");
 	a1_menu.add ((char*)"Hansl and Gretl", hansl_and_gretl )
@@ -301,10 +289,20 @@ int WINAPI WinMain (HINSTANCE hInstance, HINSTANCE hPrevInstance, PSTR szCmdLine
 	       .add ((char*)"Opdracht 1",execution);
 
 	Menu sn_menu ((char*)"Velocity");
-	sn_menu.add ((char*)"Quick", quick)
-		   .add ((char*)"Normal",normal)
-		   .add ((char*)"Slow",slow)
-		   .add ((char*)"Very slow",very_slow);
+	sn_menu.add ((char*)"Quick", quick, '1')
+		   .add ((char*)"Normal",normal, '2')
+		   .add ((char*)"Slow",slow, '3')
+		   .add ((char*)"Very slow",very_slow, '4')
+		   .add ()
+		   .add ((char*)"Faster\t+", faster)
+		   .add ((char*)"Slower\t-", slower)
+		   .add ((char*)"Turbo\tT", turbo)
+		   .add ((char*)"Single step\tSpace", single_step)
+		   .add ((char*)"Next step\tEnter", next_step)
+		   .add ()
+		   .add ((char*)"Zoom in\tI", zoom_in)
+		   .add ((char*)"Zoom out\tO", zoom_out)
+		   .setLive ();			// the speed and the zoom can be changed while Charles runs
 
     Menu o1_menu ((char*)"OPDRACHTEN");
 	o1_menu.add ((char*)"Opdracht 1", Opdracht1 )
@@ -327,3 +325,4 @@ int WINAPI WinMain (HINSTANCE hInstance, HINSTANCE hPrevInstance, PSTR szCmdLine
 
 	return 0;
 }
+#endif
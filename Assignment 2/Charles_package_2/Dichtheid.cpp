@@ -0,0 +1,73 @@
+#include "Dichtheid.h"
+
+using namespace std;
+
+void Dichtheid :: werkBij (Wereld& wereld)
+{
+	int lx, ly, rx, ry;
+	const bool gewijzigd = wereld.neemWijziging (lx, ly, rx, ry);
+
+	if (wereld.breedte () != wereld_breedte || wereld.hoogte () != wereld_hoogte)
+	{
+		wereld_breedte	= wereld.breedte ();
+		wereld_hoogte	= wereld.hoogte ();
+		lagen.clear ();
+		for (int b = wereld_breedte, h = wereld_hoogte; b > 1 || h > 1; )
+		{
+			b = (b + 1) / 2;
+			h = (h + 1) / 2;
+			Laag laag;
+			laag.breedte	= b;
+			laag.hoogte		= h;
+			laag.muren.assign	(b * h, 0);
+			laag.ballen.assign	(b * h, 0);
+			lagen.push_back (laag);
+		}
+		bereken (wereld, 0, 0, wereld_breedte, wereld_hoogte);
+	}
+	else if (gewijzigd)
+		bereken (wereld, lx, ly, rx, ry);
+}
+
+//	bereken computes the blocks above the fields from (lx,ly) up to (rx,ry), level by level.
+void Dichtheid :: bereken (Wereld& wereld, int lx, int ly, int rx, int ry)
+{
+	for (size_t n = 0; n < lagen.size (); n++)
+	{
+		lx = lx / 2;
+		ly = ly / 2;
+		rx = (rx + 1) / 2;
+		ry = (ry + 1) / 2;
+		Laag& laag = lagen [n];
+		for (int x = lx; x < rx; x++)
+			for (int y = ly; y < ry; y++)
+			{
+				int muren = 0, ballen = 0;
+				for (int i = 0; i < 4; i++)
+				{
+					const int ox = 2 * x + i / 2, oy = 2 * y + i % 2;
+					if (n == 0)
+					{
+						if (ox < wereld_breedte && oy < wereld_hoogte)
+							switch (wereld.veld (ox, oy))
+							{
+								case Muur:	muren  += 255;	break;
+								case Bal:	ballen += 255;	break;
+								default:					break;
+							}
+					}
+					else
+					{
+						const Laag& onder = lagen [n - 1];
+						if (ox < onder.breedte && oy < onder.hoogte)
+						{
+							muren  += onder.muren  [ox * onder.hoogte + oy];
+							ballen += onder.ballen [ox * onder.hoogte + oy];
+						}
+					}
+				}
+				laag.muren  [x * laag.hoogte + y] = (unsigned char) ((muren  + 2) / 4);
+				laag.ballen [x * laag.hoogte + y] = (unsigned char) ((ballen + 2) / 4);
+			}
+	}
+}
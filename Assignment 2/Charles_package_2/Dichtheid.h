@@ -0,0 +1,48 @@
+#ifndef DICHTHEID_H
+#define DICHTHEID_H
+
+#include <vector>
+
+#include "Wereld.h"
+
+/*
+	Dichtheid keeps how full a world is in blocks of fields, so that a world that is zoomed
+	out too far to draw field by field can be drawn one pixel per block (Robot.cpp). Level n
+	has blocks of 2^n x 2^n fields: level 0 is the world itself, and the last level has the
+	whole world in one block. A block has a byte for its walls and one for its balls: 0 when
+	none of its fields has one, 255 when all of them have one, and in between the mean of the
+	four blocks of the level below. Fields outside the world count as empty.
+
+	werkBij brings the levels up to date with the world. It only computes the blocks above the
+	fields that changed since it looked last (Wereld::neemWijziging), so after a step that is
+	a block per level; when the world has another size it computes every level again. No other
+	view may take the changes of the same world (such as Overzicht.h).
+*/
+
+class Dichtheid
+{
+public:
+					Dichtheid	() : wereld_breedte (0), wereld_hoogte (0) {}
+
+	void			werkBij		(Wereld& wereld);
+
+	int				niveaus		() const { return (int) lagen.size () + 1; }
+	int				breedte		(int niveau) const { return lagen [niveau - 1].breedte; }	//	in blocks; niveau >= 1
+	int				hoogte		(int niveau) const { return lagen [niveau - 1].hoogte; }
+	unsigned char	muren		(int niveau, int x, int y) const { const Laag& laag = lagen [niveau - 1]; return laag.muren [x * laag.hoogte + y]; }
+	unsigned char	ballen		(int niveau, int x, int y) const { const Laag& laag = lagen [niveau - 1]; return laag.ballen [x * laag.hoogte + y]; }
+
+private:
+	struct Laag
+	{
+		int							breedte, hoogte;
+		std::vector<unsigned char>	muren, ballen;		//	column-major, as in Wereld
+	} ;
+
+	void			bereken		(Wereld& wereld, int lx, int ly, int rx, int ry);
+
+	int					wereld_breedte, wereld_hoogte;	//	the size the levels were made for
+	std::vector<Laag>	lagen;							//	lagen [n-1] is level n
+} ;
+
+#endif
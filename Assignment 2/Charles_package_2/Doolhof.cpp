@@ -0,0 +1,327 @@
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+/*
+	The generators work on a byte per cell; cell (i,j) lies at field (2i+1, 2j+1). A cell only
+	records the passages to its east and north neighbours; the passage to the west or south
+	is recorded in that neighbour. The other bits are for the generators: whether the cell is
+	part of the maze already, and a direction (the way back for the backtracker, the last step
+	of the walk for Wilson).
+
+	The cells are surrounded by a rand of cells that are already in the maze, so a step never
+	has to check the edges. Generating is mostly deciding where to go next, at random; the
+	backtracker makes that decision without branches, from a mask of the free neighbours, and
+	its steps only load and store: every step depends on the one before, so the time of a step
+	is the time of the loads it waits for.
+
+	When the maze is ready it is written into the world 64 columns of fields at a time, as
+	words of wall bits (Wereld::laadMuren): the passage bits of 32 cells are gathered with a
+	few multiplications, and spread over the 64 fields of a word.
+*/
+
+#include "Doolhof.h"
+
+using namespace std;
+
+enum
+{	OostOpen	= 1
+,	NoordOpen	= 2
+,	InDoolhof	= 4
+,	Rand		= 8
+,	RichtingBit	= 4			//	the direction is in bits 4 and 5
+,	Begin		= 64		//	the cell the backtracker started from
+} ;
+
+//	Cellen are numbered column by column, with the rand around them.
+class Cellen
+{
+public:
+	Cellen (int breedte, int hoogte)
+		: breedte (breedte), hoogte (hoogte), kolom (hoogte + 2), cel ((breedte + 2) * (hoogte + 2) + 32, 0)
+	{
+		stap [Noord] = 1;
+		stap [West]  = -kolom;
+		stap [Zuid]  = -1;
+		stap [Oost]  = kolom;
+		for (int i = -1; i <= breedte; i++)
+			for (int j = -1; j <= hoogte; j++)
+				if (i < 0 || j < 0 || i == breedte || j == hoogte)
+					cel [nummer (i, j)] = InDoolhof | Rand;
+	}
+
+	int		nummer		(int i, int j) const { return (i + 1) * kolom + j + 1; }
+	void	open		(int c, int r)
+	{
+		switch (r)
+		{
+			case Noord:	cel [c]			  |= NoordOpen;	break;
+			case Oost:	cel [c]			  |= OostOpen;	break;
+			case Zuid:	cel [c + stap [r]] |= NoordOpen;	break;
+			default:	cel [c + stap [r]] |= OostOpen;	break;
+		}
+	}
+	int		richting	(int c) const { return (cel [c] >> RichtingBit) & 3; }
+	void	zetRichting	(int c, int r) { cel [c] = (unsigned char) ((cel [c] & ~(3 << RichtingBit)) | (r << RichtingBit)); }
+
+	const int				breedte, hoogte;
+	const int				kolom;				//	the numbers of a column of cells, with the rand
+	int						stap [4];			//	the difference of the number of a neighbour, per direction
+	vector<unsigned char>	cel;				//	and 32 bytes more, for schrijf: it reads 32 cells at a time
+} ;
+
+static int terug (int r)
+{
+	return (r + 2) & 3;
+}
+
+//	keuze [vrij][k] is direction k % n of the n directions in the mask vrij: k below 12 chooses
+//	evenly among 1, 2, 3 or 4 directions, so it can be drawn before vrij is known.
+struct Keuzes
+{
+	Keuzes ()
+	{
+		for (int vrij = 0; vrij < 16; vrij++)
+		{
+			unsigned char vrije [4] = { 0, 0, 0, 0 };
+			int n = 0;
+			for (int r = 0; r < 4; r++)
+				if (vrij & (1 << r))
+					vrije [n++] = (unsigned char) r;
+			for (int k = 0; k < 12; k++)
+				keuze [vrij][k] = vrije [n > 0 ? k % n : 0];
+		}
+	}
+	unsigned char keuze [16][12];
+} ;
+
+//	weg gives bit 0 of every byte of acht that is a cell with the way back r, without Rand or Begin.
+static unsigned long long weg (unsigned long long acht, int r)
+{
+	const unsigned long long een = 0x0101010101010101ULL;
+	const unsigned long long laag = acht >> RichtingBit & een, hoog = acht >> (RichtingBit + 1) & een;
+	return ~(acht >> 3 | acht >> 6) & (r & 1 ? laag : ~laag) & (r & 2 ? hoog : ~hoog) & een;		//	Rand is bit 3, Begin bit 6
+}
+
+/*	backtracker walks with loads and plain stores only. A step loads the four neighbours and a
+	table; the cell it enters is stored with InDoolhof and the way back, which also goes on a
+	stack, so that a step back does not have to load the cell first. The passages are opened
+	afterwards, from the ways back. The Toeval is copied into a local, which the compiler can
+	keep in a register: the stores to the cells might otherwise change it.
+*/
+static void backtracker (Cellen& d, Toeval& toeval)
+{
+	static const Keuzes keuzes;
+	Toeval eigen = toeval;
+	unsigned char *cel = &d.cel [0];
+	const int stap [4] = { d.stap [0], d.stap [1], d.stap [2], d.stap [3] };
+	int sprong [16][12];					//	the step to keuze [vrij][k]
+	for (int vrij = 0; vrij < 16; vrij++)
+		for (int k = 0; k < 12; k++)
+			sprong [vrij][k] = stap [keuzes.keuze [vrij][k]];
+	vector<unsigned char> terugweg;
+
+	int c = d.nummer (eigen.onder (d.breedte), eigen.onder (d.hoogte));
+	cel [c] = InDoolhof | Begin;
+	for (;;)
+	{
+		const int vrij = ((cel [c + stap [0]] & InDoolhof)
+					   | (cel [c + stap [1]] & InDoolhof) << 1
+					   | (cel [c + stap [2]] & InDoolhof) << 2
+					   | (cel [c + stap [3]] & InDoolhof) << 3) >> 2 ^ 15;
+		if (vrij != 0)
+		{
+			const unsigned k = eigen.onder (12);
+			const int r = terug (keuzes.keuze [vrij][k]);
+			c += sprong [vrij][k];
+			cel [c] = (unsigned char) (InDoolhof | r << RichtingBit);
+			terugweg.push_back ((unsigned char) r);
+		}
+		else if (terugweg.empty ())
+			break;
+		else
+		{
+			c += stap [terugweg.back ()];
+			terugweg.pop_back ();
+		}
+	}
+	toeval = eigen;
+
+	//	a cell is open to the north if its way back is north or that of the cell above is south,
+	//	and open to the east if its way back is east or that of the cell to the east is west. The
+	//	cells go eight at a time, as the bytes of a word; the Rand, Begin and the cells after the
+	//	last column are never a way back, so the words may run over the ends of the columns.
+	for (int c = d.nummer (0, 0); c < d.nummer (d.breedte - 1, d.hoogte); c += 8)
+	{
+		unsigned long long hier, boven, oosten;
+		memcpy (&hier,   cel + c,			8);
+		memcpy (&boven,  cel + c + 1,		8);
+		memcpy (&oosten, cel + c + d.kolom,	8);
+		hier |= (weg (hier, Noord) | weg (boven, Zuid)) << 1		//	NoordOpen
+			  |  weg (hier, Oost)  | weg (oosten, West);			//	OostOpen
+		memcpy (cel + c, &hier, 8);
+	}
+}
+
+static int wortel (vector<int>& ouder, int c)
+{
+	while (ouder [c] != c)
+		c = ouder [c] = ouder [ouder [c]];		//	path halving
+	return c;
+}
+
+//	kruskal shuffles the walls between the cells, and removes a wall when its cells are not yet joined.
+static void kruskal (Cellen& d, Toeval& toeval)
+{
+	vector<unsigned> muren;								//	number * 2 + (0: east, 1: north)
+	muren.reserve (2 * d.breedte * d.hoogte);
+	for (int i = 0; i < d.breedte; i++)
+		for (int j = 0; j < d.hoogte; j++)
+		{
+			const unsigned c = d.nummer (i, j);
+			if (i + 1 < d.breedte)
+				muren.push_back (c * 2);
+			if (j + 1 < d.hoogte)
+				muren.push_back (c * 2 + 1);
+		}
+	for (size_t k = muren.size (); k > 1; k--)
+		swap (muren [k - 1], muren [toeval.onder ((unsigned) k)]);
+
+	vector<int> ouder (d.cel.size ());
+	vector<unsigned char> rang (d.cel.size (), 0);
+	for (size_t c = 0; c < ouder.size (); c++)
+		ouder [c] = (int) c;
+	const int aantal = d.breedte * d.hoogte;
+	int samen = 1;
+	for (size_t k = 0; k < muren.size () && samen < aantal; k++)
+	{
+		const int c = muren [k] >> 1, r = (muren [k] & 1) ? Noord : Oost;
+		int a = wortel (ouder, c), b = wortel (ouder, c + d.stap [r]);
+		if (a == b)
+			continue;
+		if (rang [a] < rang [b])
+			swap (a, b);
+		ouder [b] = a;
+		if (rang [a] == rang [b])
+			rang [a]++;
+		d.open (c, r);
+		samen++;
+	}
+}
+
+//	wilson walks from every cell that is not in the maze until it reaches the maze; the last
+//	step taken out of every cell erases the loops, and that path is added to the maze.
+static void wilson (Cellen& d, Toeval& toeval)
+{
+	d.cel [d.nummer (toeval.onder (d.breedte), toeval.onder (d.hoogte))] |= InDoolhof;
+	for (int i = 0; i < d.breedte; i++)
+		for (int j = 0; j < d.hoogte; j++)
+		{
+			const int begin = d.nummer (i, j);
+			int c = begin;
+			while (!(d.cel [c] & InDoolhof))
+			{
+				int r;
+				do
+					r = toeval.onder (4);
+				while (d.cel [c + d.stap [r]] & Rand);
+				d.zetRichting (c, r);
+				c += d.stap [r];
+			}
+			for (c = begin; !(d.cel [c] & InDoolhof); )
+			{
+				const int r = d.richting (c);
+				d.cel [c] |= InDoolhof;
+				d.open (c, r);
+				c += d.stap [r];
+			}
+		}
+}
+
+//	spreid spreads the low 32 bits of v over the even bits of a word.
+static unsigned long long spreid (unsigned long long v)
+{
+	v = (v | v << 16) & 0x0000FFFF0000FFFFULL;
+	v = (v | v << 8)  & 0x00FF00FF00FF00FFULL;
+	v = (v | v << 4)  & 0x0F0F0F0F0F0F0F0FULL;
+	v = (v | v << 2)  & 0x3333333333333333ULL;
+	v = (v | v << 1)  & 0x5555555555555555ULL;
+	return v;
+}
+
+//	schrijf writes column x of the world as wall bits, a word at a time: the column between two
+//	columns of cells has a passage where the western cell is open to the east, a column of cells
+//	has its cells and the passages to the north. The bits of 32 cells are gathered and spread
+//	over the 64 fields of a word. The columns go to the world 64 at a time.
+static void schrijf (const Cellen& d, Wereld& wereld)
+{
+	const int woorden = (wereld.hoogte () + 63) / 64;
+	vector<unsigned long long> blok (64 * woorden);
+	for (int links = 0; links < wereld.breedte (); links += 64)
+	{
+		const int aantal = min (64, wereld.breedte () - links);
+		for (int x = links; x < links + aantal; x++)
+		{
+			unsigned long long *muren = &blok [(x - links) * woorden];
+			if (x == 0 || x > 2 * d.breedte)
+			{
+				fill (muren, muren + woorden, ~0ULL);
+				continue;
+			}
+
+			const unsigned char *kolom = &d.cel [d.nummer ((x - 1) / 2, 0)];
+			const int cellen = x % 2;				//	1: NoordOpen (bit 1) above the cell, 0: OostOpen (bit 0) beside it
+			unsigned long long boven = 0;			//	the passage above the last cell of the word before
+			for (int m = 0; m < woorden; m++)
+			{
+				const int eerste = 32 * m, n = max (0, min (32, d.hoogte - eerste));
+				unsigned long long open = 0;
+				for (int b = 0; n > 0 && b < 32; b += 8)
+				{
+					unsigned long long acht;					//	bit 0 of eight cells, gathered by a multiplication
+					memcpy (&acht, kolom + eerste + b, 8);
+					open |= ((acht >> cellen & 0x0101010101010101ULL) * 0x0102040810204080ULL) >> 56 << b;
+				}
+				const unsigned long long aanwezig = n == 32 ? 0xFFFFFFFFULL : (1ULL << n) - 1;
+				open &= aanwezig;
+				if (cellen)
+				{
+					muren [m] = ~(spreid (aanwezig) << 1 | spreid (open) << 2 | boven);
+					boven = open >> 31;
+				}
+				else
+					muren [m] = ~(spreid (open) << 1);
+			}
+			if (wereld.hoogte () % 64 != 0)
+				muren [woorden - 1] &= (1ULL << (wereld.hoogte () % 64)) - 1;
+		}
+		wereld.laadMuren (links, aantal, &blok [0]);
+	}
+}
+
+void maakDoolhof (Wereld& wereld, DoolhofSoort soort, unsigned long long zaad)
+{
+	Cellen doolhof (max ((wereld.breedte () - 1) / 2, 1), max ((wereld.hoogte () - 1) / 2, 1));
+	Toeval toeval (zaad);
+	switch (soort)
+	{
+		case Kruskal:	kruskal		(doolhof, toeval);	break;
+		case Wilson:	wilson		(doolhof, toeval);	break;
+		default:		backtracker	(doolhof, toeval);	break;
+	}
+	schrijf (doolhof, wereld);
+
+	wereld.zetVeld (2 * doolhof.breedte - 1, 1, Bal);
+	wereld.plaatsRobot (1, 2 * doolhof.hoogte - 1, Oost);
+}
+
+const char *doolhofNaam (DoolhofSoort soort)
+{
+	switch (soort)
+	{
+		case Backtracker:	return "backtracker";
+		case Kruskal:		return "kruskal";
+		case Wilson:		return "wilson";
+		default:			return "unknown";
+	}
+}
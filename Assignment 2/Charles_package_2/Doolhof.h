@@ -0,0 +1,34 @@
+#ifndef DOOLHOF_H
+#define DOOLHOF_H
+
+#include "Toeval.h"
+#include "Wereld.h"
+
+/*
+	Doolhof generates perfect mazes (exactly one path between every two free fields) in a
+	Wereld of any size of at least 3 x 3. The cells of the maze are the fields with two odd
+	coordinates; the fields between two cells are a wall or a passage, all other fields are
+	walls. Charles starts in the top-left cell facing east, and a ball lies in the bottom-right
+	cell, as in the labyrinth file.
+
+	Backtracker	a random depth-first search: long winding corridors and few dead ends. The
+				fastest; a 2000 x 2000 world takes some 25 ms, a 10000 x 10000 world some
+				0.6 s, plus 0.08 s to make the Wereld itself. Most of that is the walk: every
+				step waits for the one before, so more cores do not make it faster.
+	Kruskal		joins the cells along the walls in random order, with union-find: many short
+				dead ends. Some ten times slower: it shuffles all walls, and then visits
+				them in that random order.
+	Wilson		loop-erased random walks: every perfect maze is equally likely. Its first walk
+				is long in a large world (it has to find the single cell of the maze), after
+				that the walks are short; about three times as slow as the backtracker.
+
+	The same zaad gives the same maze on every platform: the generators use their own Toeval
+	(Toeval.h), not rand ().
+*/
+
+enum DoolhofSoort { Backtracker, Kruskal, Wilson, AantalDoolhofSoorten };
+
+void		maakDoolhof		(Wereld& wereld, DoolhofSoort soort, unsigned long long zaad);
+const char*	doolhofNaam		(DoolhofSoort soort);		//	"backtracker", "kruskal" or "wilson"
+
+#endif
@@ -0,0 +1,238 @@
+#include <algorithm>
+#include <climits>
+
+/*
+	Machine is the interpreter of Karel bytecode (see Programma.h).
+	The registers live in local variables while it runs, and are stored back in the
+	Toestand when it stops for any reason, including an IllegaleActie.
+*/
+
+#include "Machine.h"
+
+using namespace std;
+
+Machine :: Machine (const Programma& programma, Wereld& wereld, Arena *arena)
+	: programma (programma), _wereld (wereld), t { 0, false, false, ArenaVector<int> (arena), ArenaVector<int> (arena), 0, 0, 0 },
+	  warmte (programma.lengte (), 0, arena), lussen (programma.lengte (), Lus (), arena)
+{
+	if (!programma.isKlaar ())
+		throw ProgrammaFout ("The program must be finished (klaar) before it can be executed.");
+	begin ();
+}
+
+//	begin restarts the program from its first instruction; the world is not changed.
+void Machine :: begin ()
+{
+	t.pc			= 0;
+	t.vlag			= false;
+	t.gestopt		= false;
+	t.stapel.clear ();
+	t.tellers.clear ();
+	t.instructies	= 0;
+	t.acties		= 0;
+	t.testen		= 0;
+}
+
+#if defined(__GNUC__)
+	#define INSTRUCTIE(op)	L_##op:
+	#define VOLGENDE		do { if (--over < 0) goto op; goto *sprong [code [pc].op]; } while (0)
+	#define DISPATCH		VOLGENDE;
+	#define EINDE_DISPATCH
+#else
+	#define INSTRUCTIE(op)	case op:
+	#define VOLGENDE		continue
+	#define DISPATCH		for (;;) { if (--over < 0) goto op; switch (code [pc].op) {
+	#define EINDE_DISPATCH	default: throw ProgrammaFout ("Unknown instruction."); } }
+#endif
+
+long long Machine :: voerUit (long long maximum)
+{
+	if (t.gestopt)
+		return 0;
+	if (t.pc < 0 || t.pc >= programma.lengte ())
+		throw ProgrammaFout ("The program counter is outside the program.");
+
+#if defined(__GNUC__)
+	static const void *const sprong [AantalOpcodes] =
+		{	&&L_OP_Stap, &&L_OP_Linksom, &&L_OP_Rechtsom, &&L_OP_PakBal, &&L_OP_LegBal, &&L_OP_Draai, &&L_OP_Stappen, &&L_OP_NaarMuur
+		,	&&L_OP_MuurVoor, &&L_OP_OpBal, &&L_OP_Noord
+		,	&&L_OP_Spring, &&L_OP_SpringAls, &&L_OP_SpringAlsNiet, &&L_OP_Roep, &&L_OP_Herhaal
+		,	&&L_OP_Keer, &&L_OP_Teller, &&L_OP_Stop
+		} ;
+#endif
+
+	const Instructie *const code = &programma.code () [0];
+	Wereld&				w		= _wereld;
+	ArenaVector<int>&	stapel	= t.stapel;
+	ArenaVector<int>&	tellers	= t.tellers;
+	int					pc		= t.pc;
+	bool				vlag	= t.vlag;
+	long long			acties	= 0;
+	long long			testen	= 0;
+	const long long		budget	= (maximum > 0) ? maximum : LLONG_MAX;
+	long long			over	= budget;		//	decremented before every instruction
+
+	try
+	{
+		DISPATCH
+
+		INSTRUCTIE (OP_Stap)			w.stap ();						acties++;	pc++;	VOLGENDE;
+		INSTRUCTIE (OP_Linksom)			w.linksom ();					acties++;	pc++;	VOLGENDE;
+		INSTRUCTIE (OP_Rechtsom)		w.rechtsom ();					acties++;	pc++;	VOLGENDE;
+		INSTRUCTIE (OP_PakBal)			w.pakBal ();					acties++;	pc++;	VOLGENDE;
+		INSTRUCTIE (OP_LegBal)			w.legBal ();					acties++;	pc++;	VOLGENDE;
+		INSTRUCTIE (OP_Draai)			w.draai (code [pc].arg & 3);	acties += code [pc].arg >> 2;	pc++;	VOLGENDE;
+		INSTRUCTIE (OP_Stappen)
+		{	const int gezet = w.stappen (code [pc].arg);
+			acties += gezet;
+			if (gezet < code [pc].arg)
+				throw IllegaleActie (IA_Stap);
+			pc++;
+			VOLGENDE;
+		}
+		INSTRUCTIE (OP_NaarMuur)
+		{	const int gezet = w.naarMuur ();			//	the steps and all tests
+			acties += 2 * gezet + 1;
+			testen += gezet + 1;
+			vlag = true;
+			pc++;
+			VOLGENDE;
+		}
+		INSTRUCTIE (OP_MuurVoor)		vlag = w.muurVoor ();			acties++;	testen++;	pc++;	VOLGENDE;
+		INSTRUCTIE (OP_OpBal)			vlag = w.bovenopBal ();			acties++;	testen++;	pc++;	VOLGENDE;
+		INSTRUCTIE (OP_Noord)			vlag = w.noord ();				acties++;	testen++;	pc++;	VOLGENDE;
+		INSTRUCTIE (OP_Spring)			pc = code [pc].arg;									VOLGENDE;
+		INSTRUCTIE (OP_SpringAls)		pc = vlag ? code [pc].arg : pc + 1;					VOLGENDE;
+		INSTRUCTIE (OP_SpringAlsNiet)
+			if (vlag)
+				pc++;
+			else if (code [pc].arg < pc && ++warmte [pc] >= Warm)
+				pc = spoelDoor (pc, vlag, over, acties, testen);
+			else
+				pc = code [pc].arg;
+			VOLGENDE;
+		INSTRUCTIE (OP_Roep)
+			if (stapel.size () >= 2 * (size_t) MaximaleDiepte)
+				throw ProgrammaFout ("The program calls its routines too deeply.");
+			stapel.push_back (pc + 1);
+			stapel.push_back ((int) tellers.size ());
+			pc = code [pc].arg;
+			VOLGENDE;
+		INSTRUCTIE (OP_Herhaal)
+			if (tellers.empty ())
+				throw ProgrammaFout ("The program repeats without a counter.");
+			if (--tellers.back () > 0)
+				pc = code [pc].arg;
+			else
+			{	tellers.pop_back ();
+				pc++;
+			}
+			VOLGENDE;
+		INSTRUCTIE (OP_Teller)
+			if (tellers.size () >= (size_t) MaximaleDiepte)
+				throw ProgrammaFout ("The program nests its loops too deeply.");
+			tellers.push_back (code [pc].arg);
+			pc++;
+			VOLGENDE;
+		INSTRUCTIE (OP_Keer)
+			if (stapel.empty ())
+				goto stop;
+			tellers.resize (stapel.back ());		//	a return from inside a repeat leaves its counters behind
+			stapel.pop_back ();
+			pc = stapel.back ();
+			stapel.pop_back ();
+			VOLGENDE;
+		INSTRUCTIE (OP_Stop)
+			goto stop;
+
+		EINDE_DISPATCH
+	}
+	catch (...)
+	{
+		over++;								//	the failing instruction was not executed
+		t.pc			 = pc;
+		t.vlag			 = vlag;
+		t.instructies	+= budget - over;
+		t.acties		+= acties;
+		t.testen		+= testen;
+		throw;
+	}
+
+op:
+	over++;									//	undo the decrement of the instruction that was not executed
+	goto bewaar;
+stop:
+	t.gestopt = true;						//	Stop and the final Keer are counted
+bewaar:
+	t.pc			 = pc;
+	t.vlag			 = vlag;
+	t.instructies	+= budget - over;
+	t.acties		+= acties;
+	t.testen		+= testen;
+	return budget - over;
+}
+
+//	bekijkLus checks once whether the loop that jumps back at 'sprong' can be fast-forwarded.
+bool Machine :: bekijkLus (int sprong)
+{
+	const vector<Instructie>& code = programma.code ();
+	const int begin = code [sprong].arg;
+	if (sprong - begin < 2 || sprong - begin > 3 || code [sprong - 1].op != OP_MuurVoor)
+		return false;
+
+	Lus lus = { sprong - begin + 1, sprong - begin - 1, OP_Stap, 0 };
+	int stappen = 0;
+	for (int i = begin; i < sprong - 1; i++)
+		switch (code [i].op)
+		{
+			case OP_Stap:
+				stappen++;
+				break;
+			case OP_PakBal:
+			case OP_LegBal:
+				lus.bal			= code [i].op;
+				lus.bal_na_stap	= stappen;
+				break;
+			default:
+				return false;
+		}
+	if (stappen != 1)
+		return false;
+	lussen [sprong] = lus;
+	return true;
+}
+
+/*	spoelDoor is called when the jump back at 'sprong' is taken: Charles has no wall in front
+	and the next round starts. It returns the instruction at which to continue: after the
+	loop if Charles has reached the wall, or at its start otherwise.
+*/
+int Machine :: spoelDoor (int sprong, bool& vlag, long long& over, long long& acties, long long& testen)
+{
+	const int begin = programma.code () [sprong].arg;
+	if (warmte [sprong] == Warm && !bekijkLus (sprong))
+	{
+		warmte [sprong] = INT_MIN;
+		return begin;
+	}
+	warmte [sprong] = Warm;
+
+	const Lus& lus = lussen [sprong];
+	Wereld& w = _wereld;
+	const int vrij = w.vrijVoor ();
+	long long rondes = min ((long long) vrij, over / lus.lengte);
+	if (lus.bal != OP_Stap)
+		rondes = w.reeks (lus.bal_na_stap, (int) rondes, lus.bal == OP_PakBal);
+	if (rondes <= 0)
+		return begin;
+
+	if (lus.bal != OP_Stap)
+		w.zetBallen (lus.bal_na_stap, (int) rondes, lus.bal == OP_LegBal);
+	w.stappen ((int) rondes);
+	over	-= rondes * lus.lengte;
+	acties	+= rondes * (lus.primitieven + 1);
+	testen	+= rondes;
+	if (rondes < vrij)
+		return begin;
+	vlag = true;
+	return sprong + 1;
+}
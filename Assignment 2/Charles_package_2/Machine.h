@@ -0,0 +1,88 @@
+#ifndef MACHINE_H
+#define MACHINE_H
+
+#include "Arena.h"
+#include "Programma.h"
+#include "Wereld.h"
+
+/*
+	Machine executes a finished Programma on a Wereld.
+
+	voerUit runs at most 'maximum' instructions (0: no maximum) and returns the number it
+	executed; it stops earlier at Stop or at a Keer in the main program, after which
+	gestopt () is true. A program that is not finished can be resumed by calling voerUit
+	again. An IllegaleActie of the world is passed on; the machine then stays at the
+	instruction that caused it.
+
+	The complete state of a running program is a Toestand: it can be saved with toestand
+	and restored with herstel, for instance to restart from a checkpoint.
+
+	The tables of a machine grow with the program and its recursion; they are kept in the Arena
+	that is given to the constructor (Arena.h), or on the heap. A copy of the Toestand is on the
+	heap, so a checkpoint can outlive the arena of the run it was taken from.
+
+	The interpreter uses threaded dispatch with GCC's computed goto (every instruction
+	jumps directly to the code of the next), and a switch with other compilers.
+
+	Loops that walk to a wall are fast-forwarded. When the jump back of a loop
+	'while not MuurVoor' has been taken Warm times, the machine looks at the loop once: if
+	its body is a single Stap with at most one PakBal or LegBal before or after it, the
+	remaining rounds are checked against the balls ahead (Wereld::reeks) and done in one go
+	(Wereld::zetBallen and stappen). The rounds up to a field where a ball action would fail
+	are fast-forwarded; that round itself is executed instruction by instruction, so that it
+	fails as before. Instructions and actions are counted as if every round had been executed,
+	and the maximum of voerUit is respected.
+*/
+
+class Machine
+{
+public:
+	struct Toestand
+	{
+		int					pc;				//	the index of the next instruction
+		bool				vlag;			//	the result of the last test
+		bool				gestopt;
+		ArenaVector<int>	stapel;			//	per active call its return address and the number of counters at the call
+		ArenaVector<int>	tellers;		//	the counters of the active Herhaal loops
+		long long			instructies;	//	the number of instructions executed
+		long long			acties;			//	the number of primitives and tests executed
+		long long			testen;			//	the number of tests among them
+	} ;
+
+	enum { MaximaleDiepte = 1 << 16 };		//	deeper recursion or nesting of counters raises a ProgrammaFout
+	enum { Warm = 8 };						//	the number of rounds after which a loop is fast-forwarded
+
+				Machine			(const Programma& programma, Wereld& wereld, Arena *arena = 0);
+
+	long long	voerUit			(long long maximum = 0);
+	bool		gestopt			() const { return t.gestopt; }
+	long long	instructies		() const { return t.instructies; }
+	long long	acties			() const { return t.acties; }
+	long long	primitieven		() const { return t.acties - t.testen; }
+
+	const Toestand&	toestand	() const { return t; }
+	void		herstel			(const Toestand& toestand) { t = toestand; }
+	void		begin			();
+
+	Wereld&		wereld			() { return _wereld; }
+
+private:
+	const Programma&	programma;
+	Wereld&				_wereld;
+	Toestand			t;
+
+	struct Lus								//	a loop that can be fast-forwarded, by its jump back
+	{
+		int		lengte;						//	the instructions per round
+		int		primitieven;				//	the primitives per round
+		Opcode	bal;						//	PakBal, LegBal, or Stap if there is no ball action
+		int		bal_na_stap;				//	1 if the ball action follows the step
+	} ;
+	ArenaVector<int>	warmte;				//	per instruction: the number of jumps back taken; < 0 if it can not be fast-forwarded
+	ArenaVector<Lus>	lussen;				//	per instruction
+
+	bool		bekijkLus		(int sprong);
+	int			spoelDoor		(int sprong, bool& vlag, long long& over, long long& acties, long long& testen);
+} ;
+
+#endif
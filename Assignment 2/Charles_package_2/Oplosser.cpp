@@ -0,0 +1,263 @@
+#include <algorithm>
+#include <queue>
+
+/*
+	A pose of Charles is a field and a direction, numbered (x * hoogte + y) * 4 + richting.
+	Every primitive costs 1, so breadth-first search finds the fewest primitives; vorige and
+	actie remember for every pose (or state) how it was reached, so that the path can be
+	read back from the goal.
+*/
+
+#include "Oplosser.h"
+#include "Bereik.h"
+
+using namespace std;
+
+static const int dx [4] = { 0, -1, 0, 1 };		//	Noord, West, Zuid, Oost
+static const int dy [4] = { 1, 0, -1, 0 };
+
+class Houdingen
+{
+public:
+	Houdingen (const Wereld& wereld) : wereld (wereld), hoogte (wereld.hoogte ()), aantal (wereld.breedte () * wereld.hoogte () * 4) {}
+
+	int		houding		(int x, int y, int r) const { return ((x * hoogte + y) << 2) | r; }
+	int		veld		(int h) const { return h >> 2; }
+	int		begin		() const { return houding (wereld.x (), wereld.y (), wereld.richting ()); }
+
+	//	na gives the pose after a movement (Stap, Linksom or Rechtsom); -1 if Charles would walk into a wall.
+	int na (int h, Opcode actie) const
+	{
+		const int r = h & 3;
+		if (actie == OP_Linksom)
+			return (h & ~3) | ((r + 1) & 3);
+		if (actie == OP_Rechtsom)
+			return (h & ~3) | ((r + 3) & 3);
+		const int x = veld (h) / hoogte + dx [r], y = veld (h) % hoogte + dy [r];
+		if (x < 0 || y < 0 || x >= wereld.breedte () || y >= hoogte || wereld.veld (x, y) == Muur)
+			return -1;
+		return houding (x, y, r);
+	}
+
+	const Wereld&	wereld;
+	const int		hoogte;
+	const int		aantal;
+} ;
+
+static const long long MaximaleToestanden = 1 << 24;		//	the exact search of larger worlds takes too much memory
+
+static const Opcode bewegingen [3] = { OP_Stap, OP_Linksom, OP_Rechtsom };
+
+static void leesTerug (const vector<int>& vorige, const vector<char>& actie, int doel, vector<Opcode>& acties)
+{
+	const size_t begin = acties.size ();
+	for (int s = doel; vorige [s] >= 0; s = vorige [s])
+		acties.push_back ((Opcode) actie [s]);
+	reverse (acties.begin () + begin, acties.end ());
+}
+
+Programma Oplossing :: programma () const
+{
+	Programma p;
+	for (size_t i = 0; i < acties.size (); i++)
+		p.voegToe (acties [i]);
+	p.klaar ();
+	return p;
+}
+
+Oplossing naarVeld (const Wereld& wereld, int x, int y)
+{
+	Oplossing oplossing = { vector<Opcode> (), false, true };
+	vector<int> afstand;
+	if (afstanden (wereld, x, y, afstand) < 0 || afstand [wereld.x () * wereld.hoogte () + wereld.y ()] < 0)
+		return oplossing;
+
+	const Houdingen h (wereld);
+	vector<int>  kosten (h.aantal, -1), vorige (h.aantal, -1);
+	vector<char> actie (h.aantal, 0);
+
+	typedef pair<int, int> Kandidaat;			//	(- kosten - schatting, houding)
+	priority_queue<Kandidaat> open;
+	const int begin = h.begin ();
+	kosten [begin] = 0;
+	open.push (Kandidaat (-afstand [h.veld (begin)], begin));
+	while (!open.empty ())
+	{
+		const int s = open.top ().second;
+		const int f = -open.top ().first;
+		open.pop ();
+		if (f > kosten [s] + afstand [h.veld (s)])
+			continue;							//	an older entry of a pose that was improved
+		if (h.veld (s) == x * wereld.hoogte () + y)
+		{
+			leesTerug (vorige, actie, s, oplossing.acties);
+			oplossing.gevonden = true;
+			return oplossing;
+		}
+		for (int b = 0; b < 3; b++)
+		{
+			const int t = h.na (s, bewegingen [b]);
+			if (t >= 0 && (kosten [t] < 0 || kosten [s] + 1 < kosten [t]))
+			{
+				kosten [t] = kosten [s] + 1;
+				vorige [t] = s;
+				actie  [t] = (char) bewegingen [b];
+				open.push (Kandidaat (- kosten [t] - afstand [h.veld (t)], t));
+			}
+		}
+	}
+	return oplossing;
+}
+
+//	exact searches the states (pose, targets done) breadth-first.
+static bool exact (const Houdingen& h, const vector<int>& doelen, Opcode taak, vector<Opcode>& acties)
+{
+	const int k = (int) doelen.size (), klaar = (1 << k) - 1;
+	vector<int> index (h.aantal / 4, -1);
+	for (int i = 0; i < k; i++)
+		index [doelen [i]] = i;
+
+	const int toestanden = h.aantal << k;
+	vector<int>  vorige (toestanden, -2);
+	vector<char> actie (toestanden, 0);
+	queue<int> rij;
+	const int begin = h.begin () << k;
+	vorige [begin] = -1;
+	rij.push (begin);
+	while (!rij.empty ())
+	{
+		const int s = rij.front ();
+		rij.pop ();
+		const int houding = s >> k, gedaan = s & klaar;
+		if (gedaan == klaar)
+		{
+			leesTerug (vorige, actie, s, acties);
+			return true;
+		}
+
+		int volgende [4];
+		Opcode door [4];
+		int n = 0;
+		for (int b = 0; b < 3; b++)
+		{
+			const int t = h.na (houding, bewegingen [b]);
+			if (t >= 0)
+			{
+				volgende [n] = (t << k) | gedaan;
+				door [n++]   = bewegingen [b];
+			}
+		}
+		const int i = index [h.veld (houding)];
+		if (i >= 0 && !(gedaan & (1 << i)))
+		{
+			volgende [n] = s | (1 << i);
+			door [n++]   = taak;
+		}
+		for (int j = 0; j < n; j++)
+			if (vorige [volgende [j]] == -2)
+			{
+				vorige [volgende [j]] = s;
+				actie  [volgende [j]] = (char) door [j];
+				rij.push (volgende [j]);
+			}
+	}
+	return false;
+}
+
+//	gulzig goes each time to the nearest target that has not been done yet.
+static bool gulzig (const Houdingen& h, const vector<int>& doelen, Opcode taak, vector<Opcode>& acties)
+{
+	vector<char> open (h.aantal / 4, 0);
+	for (size_t i = 0; i < doelen.size (); i++)
+		open [doelen [i]] = 1;
+
+	vector<int>  vorige (h.aantal);
+	vector<char> actie (h.aantal);
+	int houding = h.begin ();
+	for (size_t gedaan = 0; gedaan < doelen.size (); gedaan++)
+	{
+		fill (vorige.begin (), vorige.end (), -2);
+		vorige [houding] = -1;
+		queue<int> rij;
+		rij.push (houding);
+		int gevonden = -1;
+		while (!rij.empty () && gevonden < 0)
+		{
+			const int s = rij.front ();
+			rij.pop ();
+			if (open [h.veld (s)])
+				gevonden = s;
+			else
+				for (int b = 0; b < 3; b++)
+				{
+					const int t = h.na (s, bewegingen [b]);
+					if (t >= 0 && vorige [t] == -2)
+					{
+						vorige [t] = s;
+						actie  [t] = (char) bewegingen [b];
+						rij.push (t);
+					}
+				}
+		}
+		if (gevonden < 0)
+			return false;
+
+		leesTerug (vorige, actie, gevonden, acties);
+		acties.push_back (taak);
+		open [h.veld (gevonden)] = 0;
+		houding = gevonden;
+	}
+	return true;
+}
+
+Oplossing bezoek (const Wereld& wereld, const vector<char>& doelen, Opcode actie)
+{
+	const Houdingen h (wereld);
+	vector<int> velden;
+	for (int v = 0; v < h.aantal / 4; v++)
+		if (doelen [v])
+			velden.push_back (v);
+
+	const bool klein = velden.size () <= MaximaalExact && ((long long) h.aantal << velden.size ()) <= MaximaleToestanden;
+	Oplossing oplossing = { vector<Opcode> (), false, klein };
+	if (oplossing.optimaal)
+		oplossing.gevonden = exact (h, velden, actie, oplossing.acties);
+	else
+		oplossing.gevonden = gulzig (h, velden, actie, oplossing.acties);
+	if (!oplossing.gevonden)
+		oplossing.acties.clear ();
+	return oplossing;
+}
+
+Oplossing pakBallen (const Wereld& wereld)
+{
+	vector<char> doelen (wereld.breedte () * wereld.hoogte (), 0);
+	for (int x = 0; x < wereld.breedte (); x++)
+		for (int y = 0; y < wereld.hoogte (); y++)
+			doelen [x * wereld.hoogte () + y] = (wereld.veld (x, y) == Bal);
+	return bezoek (wereld, doelen, OP_PakBal);
+}
+
+vector<char> grotVelden (const Wereld& wereld)
+{
+	const Bereik bereik (wereld);
+	vector<char> doelen (wereld.breedte () * wereld.hoogte (), 0);
+	for (int x = 0; x < wereld.breedte (); x++)
+		for (int y = 0; y < wereld.hoogte (); y++)
+			doelen [x * wereld.hoogte () + y] = (wereld.veld (x, y) == Leeg && bereik.gebied (x, y) == bereik.vanKarel ());
+	return doelen;
+}
+
+Oplossing vulGrot (const Wereld& wereld)
+{
+	return bezoek (wereld, grotVelden (wereld), OP_LegBal);
+}
+
+double efficientie (const Oplossing& referentie, long long primitieven)
+{
+	if (!referentie.gevonden)
+		return 0;
+	if (primitieven <= 0)
+		return referentie.acties.empty () ? 1 : 0;
+	return (double) referentie.acties.size () / primitieven;
+}
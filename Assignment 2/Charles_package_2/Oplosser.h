@@ -0,0 +1,50 @@
+#ifndef OPLOSSER_H
+#define OPLOSSER_H
+
+#include <vector>
+
+#include "Programma.h"
+#include "Wereld.h"
+
+/*
+	Oplosser computes reference solutions for the assignments of Charles: a sequence of
+	primitives (Stap, Linksom, Rechtsom, PakBal, LegBal) that does the task in as few
+	primitives as possible. A program that does the same task can then be scored by its
+	efficientie: the length of the reference solution divided by the number of primitives
+	the program needed.
+
+	naarVeld	walk to a field; A* search over the poses of Charles (field and direction),
+				with the distance field of the target (Bereik.h) as heuristic. Always optimal.
+	pakBallen	pick up every ball, as on a maakBallenPad path.
+	vulGrot		put a ball on every empty field that Charles can reach, as in a maakGrot cave;
+				grotVelden gives these fields.
+	bezoek		do 'actie' (PakBal or LegBal) on every field where doelen is not 0; doelen is
+				in the order of the fields of the world (x * hoogte + y).
+
+	With at most MaximaalExact targets (on worlds up to about 100 x 100) bezoek searches all
+	orders breadth-first and its solution is optimal. With more targets it goes each time to
+	the target it can reach in the fewest primitives; such a solution is usually close to
+	optimal but not guaranteed to be (optimaal is false). If a target can not be reached, gevonden is false and acties is empty.
+*/
+
+struct Oplossing
+{
+	std::vector<Opcode>	acties;
+	bool				gevonden;
+	bool				optimaal;
+
+	Programma			programma	() const;	//	the acties as a finished Programma
+} ;
+
+enum { MaximaalExact = 8 };
+
+Oplossing	naarVeld		(const Wereld& wereld, int x, int y);
+Oplossing	pakBallen		(const Wereld& wereld);
+Oplossing	vulGrot			(const Wereld& wereld);
+Oplossing	bezoek			(const Wereld& wereld, const std::vector<char>& doelen, Opcode actie);
+
+std::vector<char>	grotVelden	(const Wereld& wereld);
+
+double		efficientie		(const Oplossing& referentie, long long primitieven);	//	0 if there is no reference or no primitive
+
+#endif
@@ -0,0 +1,320 @@
+#include <climits>
+#include <vector>
+
+/*
+	optimaliseer works on the finished code, in which jumps refer to instruction indices.
+	Every pass replaces instructions in place and marks the ones it no longer needs as Weg;
+	comprimeer then removes those and moves the jumps along. An instruction that is the
+	target of a jump starts a new block: no pass combines it with the instructions before it
+	or assumes anything about the flag there.
+*/
+
+#include "Optimalisatie.h"
+
+using namespace std;
+
+typedef vector<Instructie> Code;
+
+static const Instructie	Weg				= { AantalOpcodes, 0 };
+static const long long	MaximaleDraai	= INT_MAX >> 2;		//	the largest number of turns in a Draai
+
+//	doelen counts for every instruction the number of jumps and calls to it.
+static vector<int> doelen (const Code& code)
+{
+	vector<int> aantal (code.size (), 0);
+	for (size_t i = 0; i < code.size (); i++)
+		if (Programma::heeftLabel (code [i].op))
+			aantal [code [i].arg]++;
+	return aantal;
+}
+
+//	comprimeer removes the instructions that are Weg; a jump to one of them continues at the
+//	next instruction that remains. The final Stop is never removed.
+static void comprimeer (Code& code)
+{
+	vector<int> nieuw (code.size ());
+	int aantal = 0;
+	for (size_t i = 0; i < code.size (); i++)
+	{
+		nieuw [i] = aantal;
+		if (code [i].op != AantalOpcodes)
+			aantal++;
+	}
+
+	Code uit;
+	uit.reserve (aantal);
+	for (size_t i = 0; i < code.size (); i++)
+		if (code [i].op != AantalOpcodes)
+		{
+			Instructie instructie = code [i];
+			if (Programma::heeftLabel (instructie.op))
+				instructie.arg = nieuw [instructie.arg];
+			uit.push_back (instructie);
+		}
+	code.swap (uit);
+}
+
+//	draaiing describes a turn as a number of turns and their net effect in quarter turns to
+//	the left; false if the instruction is not a turn.
+static bool draaiing (const Instructie& instructie, long long& aantal, int& links)
+{
+	switch (instructie.op)
+	{
+		case OP_Linksom:	aantal = 1; links = 1; return true;
+		case OP_Rechtsom:	aantal = 1; links = 3; return true;
+		case OP_Draai:		aantal = instructie.arg >> 2; links = instructie.arg & 3; return true;
+		default:			return false;
+	}
+}
+
+//	stappen gives the number of steps of Stap and Stappen; false for other instructions.
+static bool stappen (const Instructie& instructie, long long& n)
+{
+	switch (instructie.op)
+	{
+		case OP_Stap:		n = 1; return true;
+		case OP_Stappen:	n = instructie.arg; return true;
+		default:			return false;
+	}
+}
+
+static Instructie maakDraai (long long aantal, int links)
+{
+	const Instructie draai = { OP_Draai, (int) (aantal * 4 + (links & 3)) };
+	return draai;
+}
+
+static Instructie maakStappen (long long n)
+{
+	const Instructie stappen = { OP_Stappen, (int) n };
+	return stappen;
+}
+
+//	voegRijenSamen replaces runs of turns by a Draai and runs of steps by a Stappen.
+static bool voegRijenSamen (Code& code)
+{
+	const vector<int> doel = doelen (code);
+	bool veranderd = false;
+	for (size_t i = 0; i < code.size (); )
+	{
+		long long aantal, a;
+		int links, l;
+		size_t j = i + 1;
+		if (draaiing (code [i], aantal, links))
+		{
+			while (j < code.size () && doel [j] == 0 && draaiing (code [j], a, l) && aantal + a <= MaximaleDraai)
+			{
+				aantal += a;
+				links  += l;
+				code [j++] = Weg;
+			}
+			if (j > i + 1)
+				code [i] = maakDraai (aantal, links);
+		}
+		else if (stappen (code [i], aantal))
+		{
+			while (j < code.size () && doel [j] == 0 && stappen (code [j], a) && aantal + a <= INT_MAX)
+			{
+				aantal += a;
+				code [j++] = Weg;
+			}
+			if (j > i + 1)
+				code [i] = maakStappen (aantal);
+		}
+		veranderd = veranderd || j > i + 1;
+		i = j;
+	}
+	return veranderd;
+}
+
+//	voegLussenSamen replaces 'Teller n; x; Herhaal' by a single Stappen or Draai if x is a
+//	step or a turn.
+static bool voegLussenSamen (Code& code)
+{
+	const vector<int> doel = doelen (code);
+	bool veranderd = false;
+	for (size_t i = 0; i + 2 < code.size (); i++)
+	{
+		if (code [i].op != OP_Teller || code [i+2].op != OP_Herhaal || code [i+2].arg != (int) i + 1
+		 || doel [i+1] != 1 || doel [i+2] != 0)
+			continue;
+
+		const long long keer = code [i].arg;
+		long long aantal;
+		int links;
+		if (stappen (code [i+1], aantal) && aantal * keer <= INT_MAX)
+			code [i] = maakStappen (aantal * keer);
+		else if (draaiing (code [i+1], aantal, links) && aantal * keer <= MaximaleDraai)
+			code [i] = maakDraai (aantal * keer, links * (int) (keer & 3));
+		else
+			continue;
+		code [i+1] = code [i+2] = Weg;
+		veranderd = true;
+		i += 2;
+	}
+	return veranderd;
+}
+
+//	voegNaarMuurSamen replaces the loops that step until a wall by NaarMuur: the while loop of
+//	Vertaler, 'Spring t; l: Stap; t: MuurVoor; SpringAlsNiet l', and the loop that steps before
+//	its first test, 'l: Stap; MuurVoor; SpringAlsNiet l', which becomes 'Stap; NaarMuur'.
+static bool voegNaarMuurSamen (Code& code)
+{
+	const vector<int> doel = doelen (code);
+	bool veranderd = false;
+	for (size_t i = 0; i + 2 < code.size (); i++)
+	{
+		if (code [i].op == OP_Stap && code [i+1].op == OP_MuurVoor && code [i+2].op == OP_SpringAlsNiet
+		 && code [i+2].arg == (int) i && doel [i] == 1 && doel [i+1] == 0 && doel [i+2] == 0)
+		{
+			code [i+1].op = OP_NaarMuur;
+			code [i+2]    = Weg;
+			veranderd     = true;
+		}
+		else if (i + 3 < code.size () && code [i].op == OP_Spring && code [i].arg == (int) i + 2
+		 && code [i+1].op == OP_Stap && code [i+2].op == OP_MuurVoor && code [i+3].op == OP_SpringAlsNiet
+		 && code [i+3].arg == (int) i + 1 && doel [i+1] == 1 && doel [i+2] == 1 && doel [i+3] == 0)
+		{
+			code [i].op = OP_NaarMuur;
+			code [i+1]  = code [i+2] = code [i+3] = Weg;
+			veranderd   = true;
+		}
+	}
+	return veranderd;
+}
+
+static bool isTest (Opcode op)
+{
+	return op == OP_MuurVoor || op == OP_OpBal || op == OP_Noord;
+}
+
+//	verandert tells whether instruction op can change the result of the test.
+static bool verandert (Opcode op, Opcode test)
+{
+	switch (op)
+	{
+		case OP_Stap:
+		case OP_Stappen:
+		case OP_NaarMuur:	return test != OP_Noord;
+		case OP_Linksom:
+		case OP_Rechtsom:
+		case OP_Draai:		return test != OP_OpBal;
+		case OP_PakBal:
+		case OP_LegBal:		return test == OP_OpBal;
+		default:			return false;
+	}
+}
+
+//	verwijderTests removes tests whose result is already in the flag, and conditional jumps
+//	whose outcome is known because an earlier jump on the same result was not taken.
+static bool verwijderTests (Code& code)
+{
+	const vector<int> doel = doelen (code);
+	bool	veranderd	= false;
+	Opcode	getest		= AantalOpcodes;	//	the test whose result is in the flag; AantalOpcodes if unknown
+	int		waarde		= -1;				//	the value of the flag if it is known, -1 otherwise
+	for (size_t i = 0; i < code.size (); i++)
+	{
+		if (doel [i] > 0)
+			getest = AantalOpcodes;
+
+		const Opcode op = code [i].op;
+		if (isTest (op))
+		{
+			if (op == getest)
+			{
+				code [i]  = Weg;
+				veranderd = true;
+			}
+			else
+			{
+				getest = op;
+				waarde = -1;
+			}
+		}
+		else if (op == OP_SpringAls || op == OP_SpringAlsNiet)
+		{
+			const int springt = (op == OP_SpringAls) ? 1 : 0;	//	the value of the flag that jumps
+			if (getest != AantalOpcodes && waarde >= 0)
+			{
+				if (waarde == springt)
+				{
+					code [i].op = OP_Spring;
+					getest = AantalOpcodes;
+				}
+				else
+					code [i] = Weg;
+				veranderd = true;
+			}
+			else
+				waarde = 1 - springt;							//	the next instruction is only reached with this value
+		}
+		else if (op == OP_NaarMuur)
+		{
+			getest = OP_MuurVoor;
+			waarde = 1;
+		}
+		else if (op == OP_Spring || op == OP_Roep || op == OP_Keer || op == OP_Stop)
+			getest = AantalOpcodes;
+		else if (getest != AantalOpcodes && verandert (op, getest))
+			getest = AantalOpcodes;
+	}
+	return veranderd;
+}
+
+//	verkortSprongen lets jumps and calls to a Spring go to its target, replaces a Spring to a
+//	Keer or Stop by that instruction and removes a Spring to the next instruction.
+static bool verkortSprongen (Code& code)
+{
+	bool veranderd = false;
+	for (size_t i = 0; i < code.size (); i++)
+	{
+		if (!Programma::heeftLabel (code [i].op))
+			continue;
+
+		int doel = code [i].arg;
+		for (size_t n = 0; code [doel].op == OP_Spring && n < code.size (); n++)
+			doel = code [doel].arg;
+		if (code [doel].op == OP_Spring)					//	an endless loop of jumps is left alone
+			continue;
+		if (doel != code [i].arg)
+		{
+			code [i].arg = doel;
+			veranderd = true;
+		}
+
+		if (code [i].op == OP_Spring && (code [doel].op == OP_Keer || code [doel].op == OP_Stop))
+		{
+			code [i]  = code [doel];
+			veranderd = true;
+		}
+		else if (code [i].op == OP_Spring && doel == (int) i + 1)
+		{
+			code [i]  = Weg;
+			veranderd = true;
+		}
+	}
+	return veranderd;
+}
+
+Programma optimaliseer (const Programma& programma)
+{
+	if (!programma.isKlaar ())
+		throw ProgrammaFout ("The program must be finished (klaar) before it can be optimised.");
+
+	static bool (*const passen []) (Code&) = { voegRijenSamen, voegLussenSamen, voegNaarMuurSamen, verwijderTests, verkortSprongen };
+	const int aantal_passen = sizeof (passen) / sizeof (passen [0]);
+
+	Code code = programma.code ();
+	for (bool veranderd = true; veranderd; )
+	{
+		veranderd = false;
+		for (int p = 0; p < aantal_passen; p++)
+			if (passen [p] (code))
+			{
+				comprimeer (code);
+				veranderd = true;
+			}
+	}
+	return Programma (code);
+}
@@ -0,0 +1,29 @@
+#ifndef OPTIMALISATIE_H
+#define OPTIMALISATIE_H
+
+#include "Programma.h"
+
+/*
+	optimaliseer returns a finished Programma that does the same as the given one with fewer
+	instructions, so that the Machine spends its time on the actions of Charles rather than on
+	dispatching them. It makes these rewrites, none of which crosses the target of a jump:
+
+	*	a run of Linksom, Rechtsom and Draai becomes a single Draai that turns the net number
+		of quarter turns (modulo 4);
+	*	a run of Stap and Stappen becomes a single Stappen, which moves in one go up to the
+		first wall;
+	*	'Teller n' around a body of a single Stap, Stappen or turn becomes one Stappen or Draai;
+	*	'while not MuurVoor: Stap' becomes NaarMuur, which takes all steps at once;
+	*	a test whose result is already in the flag (the same test with no action in between
+		that can change it) is removed, and so is a conditional jump whose outcome follows
+		from an earlier one;
+	*	jumps to jumps go to the final target, and jumps to the next instruction are removed.
+
+	The optimised program performs the same primitives in the same order and raises an
+	IllegaleActie at the same one. Machine::acties counts the same primitives, but not the
+	tests that were removed.
+*/
+
+Programma	optimaliseer	(const Programma& programma);
+
+#endif
@@ -0,0 +1,135 @@
+#include <algorithm>
+
+#include "Overzicht.h"
+#include "Tellers.h"
+
+using namespace std;
+
+enum { Tussenruimte = 4 };			//	pixels between the tiles
+
+//	The colours of the fields, as pixels of a BitmapTarget (0x00RRGGBB).
+static const DWORD	LeegPixel	= 0xFFFFFF;
+static const DWORD	BalPixel	= 0x00FF00;
+static const DWORD	MuurPixel	= 0x0000FF;
+static const DWORD	KarelPixel	= 0xFF0000;
+static const RGBCOLOUR	RandKleur (0xC0, 0xC0, 0xC0);	//	between the tiles and outside the worlds
+
+static GSIZE atlasGrootte (int aantal, int kolommen, int breedte, int hoogte, int veld_pixels)
+{
+	kolommen = max (1, min (kolommen, aantal));
+	const int rijen = max (1, (aantal + kolommen - 1) / kolommen);
+	return GSIZE (kolommen * (breedte * veld_pixels + Tussenruimte) - Tussenruimte,
+				  rijen    * (hoogte  * veld_pixels + Tussenruimte) - Tussenruimte);
+}
+
+Overzicht :: Overzicht (int aantal, int kolommen, int breedte, int hoogte, int veld_pixels)
+	: max_breedte (breedte), max_hoogte (hoogte), veld_pixels (veld_pixels), tegels (aantal),
+	  atlas (atlasGrootte (aantal, kolommen, breedte, hoogte, veld_pixels))
+{
+	atlas.clear (RandKleur);
+	kolommen = max (1, kolommen);
+	for (int t = 0; t < aantal; t++)
+	{
+		Tegel& tegel = tegels [t];
+		tegel.breedte	= 0;
+		tegel.hoogte	= 0;
+		tegel.x			= -1;
+		tegel.y			= -1;
+		tegel.vuil		= false;
+		tegel.links		= (t % kolommen) * (breedte * veld_pixels + Tussenruimte);
+		tegel.boven		= (t / kolommen) * (hoogte  * veld_pixels + Tussenruimte);
+	}
+}
+
+void Overzicht :: markeer (Tegel& tegel, int lx, int ly, int rx, int ry)
+{
+	if (!tegel.vuil)
+	{
+		tegel.lx = lx; tegel.ly = ly; tegel.rx = rx; tegel.ry = ry;
+		tegel.vuil = true;
+	}
+	else
+	{
+		tegel.lx = min (tegel.lx, lx); tegel.ly = min (tegel.ly, ly);
+		tegel.rx = max (tegel.rx, rx); tegel.ry = max (tegel.ry, ry);
+	}
+}
+
+//	The first toon of a tile copies the whole world; after that only what changed.
+void Overzicht :: toon (int nummer, Wereld& wereld)
+{
+	Tegel& tegel = tegels [nummer];
+	int lx, ly, rx, ry;
+	bool gewijzigd = wereld.neemWijziging (lx, ly, rx, ry);
+
+	lock_guard<mutex> slot (tegel.slot);
+	if (tegel.x < 0)
+	{
+		tegel.breedte	= min (wereld.breedte (), max_breedte);
+		tegel.hoogte	= min (wereld.hoogte (),  max_hoogte);
+		tegel.velden.assign (tegel.breedte * tegel.hoogte, (unsigned char) Leeg);
+		lx = ly = 0;
+		rx = tegel.breedte;
+		ry = tegel.hoogte;
+		gewijzigd = true;
+	}
+	rx = min (rx, tegel.breedte);
+	ry = min (ry, tegel.hoogte);
+	if (gewijzigd && lx < rx && ly < ry)
+	{
+		for (int x = lx; x < rx; x++)
+			for (int y = ly; y < ry; y++)
+				tegel.velden [x * tegel.hoogte + y] = (unsigned char) wereld.veld (x, y);
+		markeer (tegel, lx, ly, rx, ry);
+	}
+	if (wereld.x () != tegel.x || wereld.y () != tegel.y)
+	{
+		if (tegel.x >= 0)
+			markeer (tegel, tegel.x, tegel.y, tegel.x + 1, tegel.y + 1);
+		tegel.x = wereld.x ();
+		tegel.y = wereld.y ();
+		markeer (tegel, tegel.x, tegel.y, tegel.x + 1, tegel.y + 1);
+	}
+}
+
+//	schilder paints the changed fields of a tile into the atlas; the top row of the world is
+//	at the top of the tile.
+void Overzicht :: schilder (Tegel& tegel)
+{
+	const int rx = min (tegel.rx, tegel.breedte);
+	const int ry = min (tegel.ry, tegel.hoogte);
+	const int breedte = atlas.getSize ().cx;
+	DWORD *const pixels = atlas.pixels ();
+
+	for (int x = tegel.lx; x < rx; x++)
+		for (int y = tegel.ly; y < ry; y++)
+		{
+			DWORD pixel;
+			if (x == tegel.x && y == tegel.y)
+				pixel = KarelPixel;
+			else
+				switch (tegel.velden [x * tegel.hoogte + y])
+				{
+					case Muur:	pixel = MuurPixel;	break;
+					case Bal:	pixel = BalPixel;	break;
+					default:	pixel = LeegPixel;	break;
+				}
+			DWORD *rij = pixels + (tegel.boven + (tegel.hoogte - 1 - y) * veld_pixels) * breedte + tegel.links + x * veld_pixels;
+			for (int r = 0; r < veld_pixels; r++, rij += breedte)
+				fill (rij, rij + veld_pixels, pixel);
+		}
+	if (rx > tegel.lx && ry > tegel.ly)
+		tellerPlus (T_VeldTekenen, (rx - tegel.lx) * (ry - tegel.ly));
+	tegel.vuil = false;
+}
+
+void Overzicht :: teken (Canvas& canvas, GPOINT hoek)
+{
+	for (size_t t = 0; t < tegels.size (); t++)
+	{
+		lock_guard<mutex> slot (tegels [t].slot);
+		if (tegels [t].vuil)
+			schilder (tegels [t]);
+	}
+	canvas.drawImage (atlas, hoek);
+}
@@ -0,0 +1,60 @@
+#ifndef OVERZICHT_H
+#define OVERZICHT_H
+
+#include <mutex>
+#include <vector>
+
+#include "gui_kernel.h"
+#include "Wereld.h"
+
+/*
+	Overzicht shows many worlds at once, each as a small picture (a tile) in a grid, so that
+	one window can follow a whole campaign (Campagne.h). The tiles are kept in one
+	BitmapTarget, the atlas, so that the window gets them all with a single copy. A field is
+	veld_pixels x veld_pixels pixels of its tile: a wall blue, a ball green, Charles red, an
+	empty field white.
+
+	The thread that runs world nummer calls toon after it has changed it. toon takes the
+	fields that changed since its previous call (Wereld::neemWijziging) and the position of
+	Charles, and copies them into the tile under the lock of the tile; that costs about as
+	much as the change itself, and the thread never draws. teken is called by the thread of
+	the GUI: it paints the fields that changed since the previous teken into the atlas, and
+	copies the atlas to a Canvas. How often teken is called sets the frame rate of the tiles,
+	however often the worlds change.
+
+	A tile shows the last world toon was called with for it; the worlds must fit in the
+	breedte x hoogte given to the constructor. A world that is larger is shown in part.
+*/
+
+class Overzicht
+{
+public:
+				Overzicht		(int aantal, int kolommen, int breedte, int hoogte, int veld_pixels);
+
+	int			aantal			() const { return (int) tegels.size (); }
+	GSIZE		grootte			() { return atlas.getSize (); }
+	void		toon			(int nummer, Wereld& wereld);		//	any thread; one thread per tile at a time
+	void		teken			(Canvas& canvas, GPOINT hoek);		//	the thread of the GUI
+
+private:
+	struct Tegel
+	{
+		std::mutex					slot;			//	toon and teken take turns
+		std::vector<unsigned char>	velden;			//	column-major, as in Wereld; only the part that toon has seen
+		int							breedte, hoogte;	//	of the part of the world in the tile
+		int							x, y;			//	Charles; -1 before the first toon
+		bool						vuil;			//	the fields from (lx,ly) up to (rx,ry) must be painted:
+		int							lx, ly, rx, ry;
+		int							links, boven;	//	the top-left pixel of the tile in the atlas
+	} ;
+
+	void		markeer			(Tegel& tegel, int lx, int ly, int rx, int ry);
+	void		schilder		(Tegel& tegel);
+
+	const int			max_breedte, max_hoogte;
+	const int			veld_pixels;
+	std::vector<Tegel>	tegels;
+	BitmapTarget		atlas;
+} ;
+
+#endif
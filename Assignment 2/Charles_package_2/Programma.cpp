@@ -0,0 +1,85 @@
+#include <sstream>
+
+#include "Programma.h"
+
+using namespace std;
+
+Programma :: Programma ()
+	: is_klaar (false)
+{
+}
+
+//	The code must be finished: it ends with Stop and its jumps refer to instruction indices.
+Programma :: Programma (const vector<Instructie>& klare_code)
+	: instructies (klare_code), is_klaar (true)
+{
+	if (instructies.empty () || instructies.back ().op != OP_Stop)
+		throw ProgrammaFout ("A finished program must end with Stop.");
+	for (size_t i = 0; i < instructies.size (); i++)
+		if (heeftLabel (instructies [i].op) && (instructies [i].arg < 0 || instructies [i].arg >= (int) instructies.size ()))
+			throw ProgrammaFout ("A finished program jumps outside the program.");
+}
+
+Programma& Programma :: voegToe (Opcode op, int arg)
+{
+	if (is_klaar)
+		throw ProgrammaFout ("The program is already finished.");
+	if (heeftLabel (op) && (arg < 0 || arg >= (int) labels.size ()))
+		throw ProgrammaFout ("The program uses a label that does not exist.");
+	if ((op == OP_Teller || op == OP_Stappen) && arg <= 0)
+		throw ProgrammaFout ("A counter must be positive.");
+	if (op == OP_Draai && arg < 4)
+		throw ProgrammaFout ("Draai must count at least one turn.");
+
+	Instructie instructie = { op, arg };
+	instructies.push_back (instructie);
+	return *this;
+}
+
+Label Programma :: nieuwLabel ()
+{
+	labels.push_back (-1);
+	return (Label) labels.size () - 1;
+}
+
+Programma& Programma :: plaats (Label l)
+{
+	if (l < 0 || l >= (int) labels.size ())
+		throw ProgrammaFout ("The program places a label that does not exist.");
+	if (labels [l] >= 0)
+		throw ProgrammaFout ("The program places a label twice.");
+
+	labels [l] = (int) instructies.size ();
+	return *this;
+}
+
+//	klaar replaces the labels by instruction indices and ends the program with Stop.
+void Programma :: klaar ()
+{
+	if (is_klaar)
+		return;
+
+	stop ();
+	for (size_t i = 0; i < instructies.size (); i++)
+		if (heeftLabel (instructies [i].op))
+		{
+			const int doel = labels [instructies [i].arg];
+			if (doel < 0)
+			{
+				ostringstream melding;
+				melding << "Label " << instructies [i].arg << " is used at instruction " << i << " but never placed.";
+				throw ProgrammaFout (melding.str ());
+			}
+			instructies [i].arg = doel;
+		}
+	is_klaar = true;
+}
+
+const char *Programma :: naam (Opcode op)
+{
+	static const char *namen [AantalOpcodes] =
+		{	"stap", "linksom", "rechtsom", "pakBal", "legBal", "draai", "stappen", "naarMuur", "muurVoor", "opBal", "noord"
+		,	"spring", "springAls", "springAlsNiet", "roep", "herhaal", "keer", "teller", "stop"
+		} ;
+	return (op >= 0 && op < AantalOpcodes) ? namen [op] : "?";
+}
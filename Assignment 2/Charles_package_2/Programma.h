@@ -0,0 +1,126 @@
+#ifndef PROGRAMMA_H
+#define PROGRAMMA_H
+
+#include <string>
+#include <vector>
+
+/*
+	Programma is a robot program in Karel bytecode. It is executed by a Machine (Machine.h)
+	on a headless Wereld, so that a program can be run in a sandbox, counted instruction by
+	instruction, interrupted and resumed.
+
+	The instructions are:
+
+	*	Stap, Linksom, Rechtsom, PakBal, LegBal	the primitives of Charles
+	*	Draai a*4+r, Stappen n					a turns of which the net effect is r turns to the
+											left / n steps; they are made by optimaliseer
+	*	NaarMuur								'while not MuurVoor: Stap', which leaves the flag set
+	*	MuurVoor, OpBal, Noord					tests; they set the condition flag
+	*	Spring l								continue at label l
+	*	SpringAls l, SpringAlsNiet l			continue at label l if the flag is set / not set
+	*	Roep l, Keer							call the routine at label l / return from it
+	*	Teller n, Herhaal l						push a counter n / decrement the top counter and
+											continue at label l while it is not 0 (then pop it)
+	*	Stop									end the program (so does Keer in the main program)
+
+	A program is built with the methods of the same name. Jumps and calls refer to labels:
+	nieuwLabel creates one, plaats puts it before the next instruction. A label may be used
+	before it is placed; klaar checks that all labels have been placed and resolves them.
+
+		Programma p;
+		Label lus = p.nieuwLabel (), vrij = p.nieuwLabel ();
+		p.plaats (lus);
+		p.muurVoor ().springAlsNiet (vrij).linksom ().spring (lus);
+		p.plaats (vrij);
+		p.stap ().spring (lus);
+		p.klaar ();
+*/
+
+enum Opcode
+	{	OP_Stap
+	,	OP_Linksom
+	,	OP_Rechtsom
+	,	OP_PakBal
+	,	OP_LegBal
+	,	OP_Draai
+	,	OP_Stappen
+	,	OP_NaarMuur
+	,	OP_MuurVoor
+	,	OP_OpBal
+	,	OP_Noord
+	,	OP_Spring
+	,	OP_SpringAls
+	,	OP_SpringAlsNiet
+	,	OP_Roep
+	,	OP_Herhaal
+	,	OP_Keer
+	,	OP_Teller
+	,	OP_Stop
+	,	AantalOpcodes
+	} ;
+
+struct Instructie
+{
+	Opcode	op;
+	int		arg;			//	the target of jumps and calls (after klaar: an instruction index), or a count
+} ;
+
+typedef int Label;
+
+//	ProgrammaFout is thrown for programs that are built or run incorrectly.
+class ProgrammaFout
+{
+public:
+	ProgrammaFout (const std::string& melding) : _melding (melding) {}
+	const std::string& melding () const { return _melding; }
+	void report () const;
+private:
+	std::string _melding;
+} ;
+
+class Programma
+{
+public:
+				Programma		();
+				Programma		(const std::vector<Instructie>& klare_code);	//	a finished program
+
+	Programma&	stap			() { return voegToe (OP_Stap); }
+	Programma&	linksom			() { return voegToe (OP_Linksom); }
+	Programma&	rechtsom		() { return voegToe (OP_Rechtsom); }
+	Programma&	pakBal			() { return voegToe (OP_PakBal); }
+	Programma&	legBal			() { return voegToe (OP_LegBal); }
+	Programma&	draai			(int aantal, int links) { return voegToe (OP_Draai, aantal * 4 + ((links % 4) + 4) % 4); }
+	Programma&	stappen			(int n) { return voegToe (OP_Stappen, n); }
+	Programma&	naarMuur		() { return voegToe (OP_NaarMuur); }
+	Programma&	muurVoor		() { return voegToe (OP_MuurVoor); }
+	Programma&	opBal			() { return voegToe (OP_OpBal); }
+	Programma&	noord			() { return voegToe (OP_Noord); }
+	Programma&	spring			(Label l) { return voegToe (OP_Spring, l); }
+	Programma&	springAls		(Label l) { return voegToe (OP_SpringAls, l); }
+	Programma&	springAlsNiet	(Label l) { return voegToe (OP_SpringAlsNiet, l); }
+	Programma&	roep			(Label l) { return voegToe (OP_Roep, l); }
+	Programma&	keer			() { return voegToe (OP_Keer); }
+	Programma&	teller			(int n) { return voegToe (OP_Teller, n); }
+	Programma&	herhaal			(Label l) { return voegToe (OP_Herhaal, l); }
+	Programma&	stop			() { return voegToe (OP_Stop); }
+
+	Programma&	voegToe			(Opcode op, int arg = 0);		//	any instruction
+
+	Label		nieuwLabel		();
+	Programma&	plaats			(Label l);
+	void		klaar			();
+	bool		isKlaar			() const { return is_klaar; }
+
+	const std::vector<Instructie>&	code	() const { return instructies; }
+	int			lengte			() const { return (int) instructies.size (); }
+
+	static const char *naam		(Opcode op);
+	static bool	heeftLabel		(Opcode op) { return op >= OP_Spring && op <= OP_Herhaal; }
+
+private:
+	std::vector<Instructie>	instructies;
+	std::vector<int>		labels;			//	the instruction index of each label; -1 if not placed
+	bool					is_klaar;
+} ;
+
+#endif
@@ -1,5 +1,12 @@
 //#include <strstream>
 #include <fstream>
+#include <sstream>
+#include <cstdlib>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
 
 /*
 	Robot is a library to draw and manipulate a simple robot in a window.
@@ -8,22 +15,18 @@
 */
 
 #include "Robot.h"
+#include "Campagne.h"
+#include "Dichtheid.h"
+#include "Machine.h"
+#include "Optimalisatie.h"
+#include "Overzicht.h"
+#include "Programma.h"
+#include "Tellers.h"
+#include "Spoor.h"
+#include "Vertaler.h"
 
 using namespace std;
 
-enum Veld { Leeg, Bal, Muur };
-
-enum Richting { Noord, West, Zuid, Oost };
-
-void rechthoek (int lx, int ly, int rx, int ry, Veld veld,
-				Veld w[WereldBreedte][WereldHoogte] )
-{
-	for (int b = lx; b < rx; b++)
-		w [b][ly] = w [b][ry-1] = veld;
-	for (int h = ly + 1; h < ry - 1; h++)
-		w [lx][h] = w [rx-1][h] = veld;
-}
-
 void IllegaleActie :: report ()
 {
 	switch (_actie)
@@ -43,13 +46,28 @@ void IllegaleActie :: report ()
 	case IA_Open:
 		makeAlert ("It was not possible to open the labyrinth.\nProbably it is in the wrong directory!");
 		break;
+	case IA_Limiet:
+		makeAlert ("Charles has performed too many actions.");
+		break;
+	case IA_Onderbroken:
+		makeAlert ("Charles was interrupted.");
+		break;
+	case IA_Gesloten:					// there is no window left to report in
+		break;
 	}
 }
 
+void ProgrammaFout :: report () const
+{
+	makeAlert (melding ().c_str ());
+}
+
 class ROBOT
 {
 public:
 	void stap			();
+	void stappen		(int n);
+	void naarMuur		();
 	void linksom 		();
 	void rechtsom 		();
 
@@ -61,13 +79,24 @@ public:
 	bool muurVoor		();
 	bool noord			();
 
-	void rust			(int);
+	void rust			(double);
+	void stappenPerSeconde	(double);
+	void sneller		();
+	void langzamer		();
+	void turbo			(bool aan);
+	bool turboAan		() const { return turbo_aan; }
+	void stapVoorStap	(bool aan);
+	bool stapVoorStapAan() const { return stap_voor_stap; }
+	void volgendeStap	() { volgende = true; }
+	void onderbreek		() { onderbroken = true; }
+	void eindeOpdracht	();
 
 	void maakWereldLeeg ();
 	void nieuweWereld	(const char wereld []);
 	void reset			();
-	void herteken		(Canvas&);
 	void herteken		();
+	void toonWijzigingen();
+	void hertekenDeel	(int from_x, int from_y, int to_x, int to_y);
 	ROBOT (int st, Richting r, int x, int y);
 	void tekenWereld	(Canvas&);
 	void tekenRobot		(Canvas&);
@@ -81,16 +110,61 @@ public:
 	void maakBallenPad   () ;                                  // toegevoegd door Peter
 	void grotwand        (Richting richting) ;                 // toegevoegd door Peter
 	void maakGrot        () ;                                  // toegevoegd door Peter
+	void maakDoolhof     (DoolhofSoort soort, unsigned long long zaad) ;
 	void creeerBal       (int x, int y);                       // toegevoegd door Peter
+	void beginWijziging	 ();
+	void voerWijzigingDoor ();
+
+	Wereld&		model		() { return wereld; }
+	void		tekenModus	(bool aan) { tekenen = aan; }
+	long long	aantalActies() const { return acties; }
+	void		actieLimiet	(long long n) { limiet = n; acties = 0; }
+	void		toonStatistiek	(bool aan);
+	bool		statistiekZichtbaar	() const { return statistiek_zichtbaar; }
+	void		tekenStatistiek	(Canvas&);
+	void		toonOverzicht	(Overzicht *o);
+	bool		overzichtGetoond	() const { return overzicht != 0; }
+	void		tekenOverzicht	(Canvas&);
+	void		campagneOverzicht	();
+	void		zoomIn			() { zoomNaar (zoom - 1); }
+	void		zoomUit			() { zoomNaar (zoom + 1); }
 
 protected:
-	Richting	huidige_richting;
-	int			x_pos;
-	int			y_pos;
-	int			stap_tijd;
+	Wereld		wereld;
+	double		stap_tijd;		// the pause after a drawn primitive in milliseconds (0: no pause)
+	LONGLONG	stap_moment;	// klok () at which the last pause ended
+	bool		turbo_aan;		// the primitives neither draw nor pause until turbo is switched off
+	bool		stap_voor_stap;	// a drawn primitive waits for volgendeStap ()
+	bool		volgende;		// volgendeStap () has been called
+	bool		onderbroken;	// onderbreek () has been called: the next pomp throws IA_Onderbroken
+	LONGLONG	laatste_pomp;	// klok () of the last pomp
+	bool		tekenen;		// false: the primitives only change the world, without drawing or pausing
+	long long	acties;			// the number of primitives performed
+	long long	limiet;			// IllegaleActie (IA_Limiet) when acties exceeds limiet (0: no limit)
+	bool		statistiek_zichtbaar;	// the counters are shown in the top-left corner of the window
+	DWORD		statistiek_getoond;		// GetTickCount() of the last time they were drawn
+	bool		vuil;					// part of the world has changed since the last frame:
+	int			vuil_lx, vuil_ly;		// the fields from (vuil_lx,vuil_ly)
+	int			vuil_rx, vuil_ry;		// to (vuil_rx,vuil_ry) must be redrawn
+	LONGLONG	laatste_beeld;			// klok () of the last frame
+	int			wijzigingen;			// the number of beginWijziging without voerWijzigingDoor
+	Overzicht	*overzicht;				// shown instead of the world; 0 if none
+	TimerId		overzicht_timer;		// redraws it OverzichtBeeldenPerSeconde times per second
+	TimerId		beeld_timer;			// draws a postponed frame; -1 if no frame is postponed
+	int			zoom;					// the zoom level; 0: a field is 2 * SteenGrootte pixels
+	Dichtheid	dichtheid;				// of the world, from which it is drawn when zoomed out far
+	unique_ptr<BitmapTarget>	dichtheid_beeld;	// the pixels of the blocks that are drawn
 private:
 	void tekenWereldDeel	(Canvas &canvas, int from_x, int from_y, int to_x, int to_y);
 	void wisWereldDeel		(Canvas &canvas, int from_x, int from_y, int to_x, int to_y);
+	void tekenDichtheid		(Canvas &canvas, int from_x, int from_y, int to_x, int to_y);
+	bool zichtbaarDeel		(Canvas &canvas, int& from_x, int& from_y, int& to_x, int& to_y);
+	void zoomNaar			(int z);
+	int  veldPixels			() const;
+	int  blokNiveau			() const;
+	bool dichtheidZoom		() const;
+	GPOINT schermPunt		(int kx, int ky) const;
+	GPOINT celHoek			(int cx, int cy) const;
 
 	void tekenMuur			(Canvas &canvas, int x, int y);
 	void tekenSteen			(Canvas &canvas, int x, int y);
@@ -99,9 +173,20 @@ private:
 
 
 	void pauze 				();
+	void pomp				(double wacht);
+	bool toont				() const { return tekenen && !turbo_aan && overzicht == 0; }
+	void tel				(Teller soort);
+	void telReeks			(Teller soort, long long n);
+	bool binnenLimiet		(long long n) const { return limiet <= 0 || acties + n <= limiet; }
+	void ververs				(Canvas&);
+	void markeer			(int x, int y);
+	void markeerGebied		(int lx, int ly, int rx, int ry);
+	void gewijzigd			(int lx, int ly, int rx, int ry);
+	void presenteer			(bool direct);
+	void stopBeeldTimer		();
+	void toonWereld			(bool wissen, bool met_robot);
 	GPOINT schermPos (int sin_richting, int cos_richting, int hoek_nr);
 
-	Veld 		Wereld [WereldBreedte][WereldHoogte];
 	double		hoeken [4][2];
 } ;
 
@@ -109,12 +194,6 @@ const int xInit = 1;
 const int yInit = WereldHoogte-2;
 const Richting rInit = Oost;
 
-void rechthoek (int lx, int ly, int rx, int ry, Veld veld,
-				Veld w[WereldBreedte][WereldHoogte] );
-
-
-extern int kies3 ();
-
 class Robot : public ROBOT
 {
 public:
@@ -124,17 +203,16 @@ public:
 
 void ROBOT :: maakWereldLeeg ()
 {
-	for (int b = 0; b < WereldBreedte; b++)
-		for (int h = 0; h < WereldHoogte; h++)
-			 Wereld [b][h] = Leeg;
+	wereld.maakLeeg ();
 }
 
 ROBOT :: ROBOT (int st, Richting r, int x, int y)
-	: huidige_richting (r), x_pos (x), y_pos (y), stap_tijd (st)
+	: wereld (), stap_tijd (st), stap_moment (0), turbo_aan (false), stap_voor_stap (false),
+	  volgende (false), onderbroken (false), laatste_pomp (0), tekenen (true), acties (0), limiet (0),
+	  statistiek_zichtbaar (false), statistiek_getoond (0), vuil (false), laatste_beeld (0), wijzigingen (0),
+	  overzicht (0), overzicht_timer (-1), beeld_timer (-1), zoom (0)
 {
-	maakWereldLeeg ();
-
-	rechthoek (0,0,WereldBreedte,WereldHoogte,Muur,Wereld);
+	wereld.plaatsRobot (x, y, r);
 
 	const double EDWD	= 0.5773502691896;	// EDWD = Een derde wortel drie
 	const double staart_grootte = (EDWD + 0.2) * RobotGrootte / 2;
@@ -148,152 +226,665 @@ ROBOT :: ROBOT (int st, Richting r, int x, int y)
 	hoeken [3][0] = 0;
 	hoeken [3][1] = EDWD * RobotGrootte;
 
-	if (x_pos < 1 || y_pos < 1 || x_pos >= WereldBreedte - 1 || y_pos >= WereldHoogte - 1 || Wereld [1][y_pos] == Muur)
+	if (x < 1 || y < 1 || x >= wereld.breedte () - 1 || y >= wereld.hoogte () - 1 || wereld.veld (1, y) == Muur)
 		throw IllegaleActie (IA_Karel);
 }
 
+//	klok is the performance counter; it runs at klokFrequentie () ticks per second.
+static LONGLONG klok ()
+{
+	LARGE_INTEGER nu;
+	QueryPerformanceCounter (&nu);
+	return nu.QuadPart;
+}
+
+static LONGLONG klokFrequentie ()
+{
+	static LONGLONG frequentie = 0;
+	if (frequentie == 0)
+	{
+		LARGE_INTEGER f;
+		QueryPerformanceFrequency (&f);
+		frequentie = f.QuadPart;
+	}
+	return frequentie;
+}
+
+static LONGLONG beeldInterval ()
+{
+	return klokFrequentie () / BeeldenPerSeconde;
+}
+
+/*	pauze waits until stap_tijd has passed since the end of the previous pause, so that the
+	speed does not depend on how long drawing takes, and fractions of a millisecond are
+	honoured on average. Charles does not catch up on pauses he fell behind on.
+	In single step mode pauze waits for volgendeStap () instead.
+	While waiting the window keeps reacting to the user.
+*/
 void ROBOT ::  pauze ()
 {
-	DWORD eind_tijd = GetTickCount() + stap_tijd;
+	SpoorStuk spoor ("pauze");
+
+	if (stap_voor_stap)
+	{
+		while (stap_voor_stap && !volgende)
+			pomp (100);
+		volgende	= false;
+		stap_moment	= klok ();
+		return;
+	}
+	if (stap_tijd <= 0)
+		return;
+
+	const LONGLONG periode = (LONGLONG) (stap_tijd * klokFrequentie () / 1000.0);
+	LONGLONG nu = klok ();
+	if (stap_moment + periode < nu)
+		stap_moment = nu;
+	else
+		stap_moment += periode;
+
+	while ((nu = klok ()) < stap_moment)
+	{
+		const double over = (stap_moment - nu) * 1000.0 / klokFrequentie ();
+		if (over > 2)
+			pomp (over - 1);		// the wait of Windows is not precise; the last millisecond is spun
+	}
+}
+
+//	pomp lets the window react to the user while Charles runs (see GUI::ProcessMessages).
+//	It ends the running command with IA_Gesloten when the window has been closed, and with
+//	IA_Onderbroken when the user pressed Escape.
+void ROBOT :: pomp (double wacht)
+{
+	laatste_pomp = klok ();
+	if (!karelsWereld().ProcessMessages (wacht))
+		throw IllegaleActie (IA_Gesloten);
+	if (onderbroken)
+	{
+		onderbroken = false;
+		throw IllegaleActie (IA_Onderbroken);
+	}
+}
+
+inline void ROBOT :: tel (Teller soort)
+{
+	tellerPlus (soort);
+	if (++acties > limiet && limiet > 0)
+		throw IllegaleActie (IA_Limiet);
+	if ((acties & 1023) == 0 && tekenen && klok () - laatste_pomp > beeldInterval ())
+		pomp (0);					// also in turbo mode and without pauses the window keeps reacting
+}
+
+//	telReeks counts n primitives of one kind at once; the caller has checked binnenLimiet.
+void ROBOT :: telReeks (Teller soort, long long n)
+{
+	tellerPlus (soort, n);
+	const long long voor = acties;
+	acties += n;
+	if ((voor >> 10) != (acties >> 10) && tekenen && klok () - laatste_pomp > beeldInterval ())
+		pomp (0);
+}
+
+/*	Presentation is decoupled from the primitives: a primitive only marks the fields around
+	Charles as changed (markeer) and asks for a frame (presenteer). A frame redraws everything
+	that changed since the previous frame, and is drawn at most BeeldenPerSeconde times per
+	second, unless the primitive pauses long enough to show every step on its own.
+	When presenteer postpones a frame it starts a timer that draws it one frame later, so
+	that the frame after the last primitive of a routine is drawn too; the timer is stopped
+	as soon as the frame has been drawn, so an idle window is not woken up.
+*/
+void ROBOT :: markeer (int x, int y)
+{
+	markeerGebied (x - 1, y - 1, x + 1, y + 1);
+}
+
+void ROBOT :: markeerGebied (int lx, int ly, int rx, int ry)
+{
+	lx = max (lx, 0);
+	ly = max (ly, 0);
+	rx = min (rx, wereld.breedte () - 1);
+	ry = min (ry, wereld.hoogte () - 1);
+	if (lx > rx || ly > ry)
+		return;
+	if (!vuil)
+	{
+		vuil_lx = lx; vuil_ly = ly; vuil_rx = rx; vuil_ry = ry;
+		vuil = true;
+	}
+	else
+	{
+		vuil_lx = min (vuil_lx, lx); vuil_ly = min (vuil_ly, ly);
+		vuil_rx = max (vuil_rx, rx); vuil_ry = max (vuil_ry, ry);
+	}
+}
+
+static void toonLaatsteBeeld (TimerId, void *robot)
+{
+	((ROBOT*) robot) -> toonWijzigingen ();
+}
+
+void ROBOT :: presenteer (bool direct)
+{
+	if (!vuil)
+		return;
+	const LONGLONG nu = klok ();
+	if (!direct && nu - laatste_beeld < beeldInterval ())
+	{
+		if (beeld_timer < 0)
+			beeld_timer = karelsWereld().addTimer (1000.0 / BeeldenPerSeconde, toonLaatsteBeeld, this);
+		return;
+	}
 
-	while (GetTickCount() < eind_tijd)
-		;
+	SpoorStuk spoor ("presenteer");
+
+	Canvas canvas (karelsWereld());
+	tellerPlus		(T_Herteken);
+	wisWereldDeel 	(canvas, vuil_lx, vuil_ly, vuil_rx, vuil_ry);
+	tekenWereldDeel	(canvas, vuil_lx, vuil_ly, vuil_rx, vuil_ry);
+	tekenRobot		(canvas);
+	ververs			(canvas);
+
+	vuil = false;
+	laatste_beeld = nu;
+	stopBeeldTimer ();
+}
+
+void ROBOT :: stopBeeldTimer ()
+{
+	if (beeld_timer >= 0)
+	{
+		karelsWereld().removeTimer (beeld_timer);
+		beeld_timer = -1;
+	}
+}
+
+void ROBOT :: toonWijzigingen ()
+{
+	stopBeeldTimer ();
+	presenteer (true);
 }
 
 void ROBOT :: linksom ()
 {
-	huidige_richting = (Richting) ((huidige_richting + 1) % 4);
+	tel (T_Draai);
+	wereld.linksom ();
 	herteken ();
 }
 
 void ROBOT :: rechtsom ()
 {
-	huidige_richting = (Richting) ((huidige_richting + 3) % 4);
+	tel (T_Draai);
+	wereld.rechtsom ();
 	herteken ();
 }
 
 inline bool ROBOT :: bovenopBal ()
 {
-	return (Wereld [x_pos][y_pos] == Bal);
+	tel (T_Test);
+	return wereld.bovenopBal ();
 }
 
 void ROBOT :: pakBal ()
 {
-	if (bovenopBal())
-		Wereld [x_pos][y_pos] = Leeg;
-	else
-		throw IllegaleActie (IA_PakBal);
+	tel (T_PakBal);
+	wereld.pakBal ();
 	herteken ();
 }
 
 void ROBOT :: legBal ()
 {
-	if (Wereld [x_pos][y_pos] == Leeg)
-		Wereld [x_pos][y_pos]  = Bal;
-	else
-		throw IllegaleActie (IA_LegBal);
+	tel (T_LegBal);
+	wereld.legBal ();
 	herteken ();
 }
 
 void ROBOT :: stap	()
 {
-	Canvas canvas (karelsWereld());
-
-	wisWereldDeel 	(canvas, x_pos - 1, y_pos - 1, x_pos + 1, y_pos + 1);
-	tekenWereldDeel	(canvas, x_pos - 1, y_pos - 1, x_pos + 1, y_pos + 1);
+	SpoorStuk spoor ("stap");
 
-	switch (huidige_richting)
+	tel (T_Stap);
+	if (!toont ())
 	{
-		case Noord:
-			if (Wereld [x_pos][y_pos+1] == Muur)
-				throw IllegaleActie (IA_Stap);
-			else
-				y_pos++;
-			break;
-		case Oost:
-			if (Wereld [x_pos+1][y_pos] == Muur)
-				throw IllegaleActie (IA_Stap);
-			else
-				x_pos++;
-			break;
-		case Zuid:
-			if (Wereld [x_pos][y_pos-1] == Muur)
-				throw IllegaleActie (IA_Stap);
-			else
-				y_pos--;
-			break;
-		case West:
-			if (Wereld [x_pos-1][y_pos] == Muur)
-				throw IllegaleActie (IA_Stap);
-			else
-				x_pos--;
-			break;
+		wereld.stap ();
+		return;
 	}
 
-	tekenRobot		(canvas);
-	pauze			();
+	markeer			(wereld.x (), wereld.y ());
+	wereld.stap		();
+	herteken		();
 }
 
 
-bool ROBOT :: muurVoor	()
+/*	stappen and naarMuur do the same as the loops of stap and muurVoor they replace, and are
+	counted the same. When the steps are shown, or the action limit would be reached halfway,
+	they are those loops; otherwise the distance to the wall is looked up in the world and all
+	steps are taken at once.
+*/
+void ROBOT :: stappen (int n)
 {
-	switch (huidige_richting)
+	const int vrij = wereld.vrijVoor ();
+	const int pogingen = min (n, vrij + 1);		// up to and including the step into a wall
+	if (n <= 0 || toont () || !binnenLimiet (pogingen))
 	{
-		case Noord:
-			return (Wereld [x_pos][y_pos+1] == Muur);
-		case Oost:
-			return (Wereld [x_pos+1][y_pos] == Muur);
-		case Zuid:
-			return (Wereld [x_pos][y_pos-1] == Muur);
-		case West:
-			return (Wereld [x_pos-1][y_pos] == Muur);
-		default :				// dit stukje is toegevoegd door Ger
-			return false ;		// om compiler-warnings te voorkomen
+		for (int i = 0; i < n; i++)
+			stap ();
+		return;
+	}
+
+	SpoorStuk spoor ("stappen");
+	wereld.stappen (n);
+	telReeks (T_Stap, pogingen);
+	if (n > vrij)
+		throw IllegaleActie (IA_Stap);
+}
+
+void ROBOT :: naarMuur ()
+{
+	const int vrij = wereld.vrijVoor ();
+	if (toont () || !binnenLimiet (2LL * vrij + 1))
+	{
+		while (!muurVoor ())
+			stap ();
+		return;
 	}
+
+	SpoorStuk spoor ("naarMuur");
+	wereld.naarMuur ();
+	telReeks (T_Stap, vrij);
+	telReeks (T_Test, vrij + 1);
+}
+
+bool ROBOT :: muurVoor	()
+{
+	tel (T_Test);
+	return wereld.muurVoor ();
 }
 
 bool ROBOT :: noord		()
 {
-	return huidige_richting == Noord;
+	tel (T_Test);
+	return wereld.noord ();
 }
 
-void ROBOT :: rust (int r)
+void ROBOT :: rust (double r)
 {
-	stap_tijd = r;
+	stap_tijd = max (r, 0.0);
 }
 
-GPOINT naarGPOINT (int x, int y)
+void ROBOT :: stappenPerSeconde (double n)
 {
-	const int x_verpl = 12, y_verpl = 12;
-	return GPOINT (x + x_verpl, SCREENHEIGHT - y - y_verpl);
+	stap_tijd = (n > 0) ? 1000.0 / n : 0;
 }
 
-GPOINT ROBOT :: schermPos (int sin_richting, int cos_richting, int hoek_nr)
+void ROBOT :: sneller ()
 {
-	double x = x_pos * 2 * SteenGrootte + cos_richting * hoeken[hoek_nr][0] - sin_richting * hoeken[hoek_nr][1];
-	double y = y_pos * 2 * SteenGrootte + sin_richting * hoeken[hoek_nr][0] + cos_richting * hoeken[hoek_nr][1];
-	return naarGPOINT (int (x), int (y));
+	stap_tijd /= 2;
+	if (stap_tijd < 0.001)
+		stap_tijd = 0;
 }
 
-void ROBOT :: herteken (Canvas &canvas)
+void ROBOT :: langzamer ()
 {
-	wisWereldDeel 	(canvas, x_pos - 1, y_pos - 1, x_pos + 1, y_pos + 1);
-	tekenWereldDeel	(canvas, x_pos - 1, y_pos - 1, x_pos + 1, y_pos + 1);
-	tekenRobot		(canvas);
-	pauze			();
+	stap_tijd = (stap_tijd <= 0) ? 1 : stap_tijd * 2;
+}
+
+//	When turbo mode is switched off the world is drawn as it is then.
+void ROBOT :: turbo (bool aan)
+{
+	turbo_aan = aan;
+	if (!aan)
+		toonWereld (true, true);
+}
+
+void ROBOT :: stapVoorStap (bool aan)
+{
+	stap_voor_stap	= aan;
+	volgende		= false;
+}
+
+/*	The zoom levels (zoom_in, zoom_out) draw a field in ZoomPixels [zoom] pixels. Up to
+	DichtheidZoom a field has bricks, a ball or a dot of its size; from there on the world is a
+	picture with a pixel per field, coloured as in an overview (Overzicht.h), and drawn with a
+	single copy. Past the end of ZoomPixels a pixel is a block of 2 x 2, 4 x 4, ... fields,
+	coloured by how many walls and balls it has (Dichtheid.h), until the whole world is one
+	block. Only the fields in the window are drawn, so a frame costs at most a window full of
+	fields or pixels, however large the world is.
+
+	The top-left corner of the world is at (RandGrootte / 2, RandGrootte / 2) at every zoom
+	level, with the top row of the world at the top.
+*/
+static const int	ZoomPixels []		= { 2 * SteenGrootte, SteenGrootte, 4, 3, 2, 1 };
+const int			AantalZoomPixels	= sizeof (ZoomPixels) / sizeof (ZoomPixels [0]);
+const int			DichtheidZoom		= 3;
+const int			KarelPixels			= 4;	// Charles is a square of at least about this size when zoomed out far
+
+int ROBOT :: veldPixels () const
+{
+	return zoom < AantalZoomPixels ? ZoomPixels [zoom] : 1;
 }
 
+//	blokNiveau is the level of Dichtheid of which a block is a pixel; 0: a field is veldPixels () pixels.
+int ROBOT :: blokNiveau () const
+{
+	return max (zoom - (AantalZoomPixels - 1), 0);
+}
+
+bool ROBOT :: dichtheidZoom () const
+{
+	return zoom >= DichtheidZoom;
+}
+
+//	schermPunt is the pixel of a point of the world in quarter fields: (4x,4y) is the centre of field (x,y).
+GPOINT ROBOT :: schermPunt (int kx, int ky) const
+{
+	const int f = veldPixels ();
+	return GPOINT (RandGrootte / 2 + (kx + 2) * f / 4, RandGrootte / 2 + (4 * wereld.hoogte () - 2 - ky) * f / 4);
+}
+
+//	celHoek is the top-left pixel of the block (cx,cy) of blokNiveau ().
+GPOINT ROBOT :: celHoek (int cx, int cy) const
+{
+	const int niveau = blokNiveau (), f = veldPixels ();
+	const int cellen_hoog = (wereld.hoogte () + (1 << niveau) - 1) >> niveau;
+	return GPOINT (RandGrootte / 2 + cx * f, RandGrootte / 2 + (cellen_hoog - 1 - cy) * f);
+}
+
+//	zichtbaarDeel narrows the fields from (from_x,from_y) to (to_x,to_y) to those in the window; false if none is.
+bool ROBOT :: zichtbaarDeel (Canvas &canvas, int& from_x, int& from_y, int& to_x, int& to_y)
+{
+	const GPOINT origin		= canvas.getOrigin ();
+	const GSIZE  venster	= karelsWereld().getWindowSize ();
+	const int f = veldPixels (), k = 1 << blokNiveau ();
+	const int links = origin.x - RandGrootte / 2, rechts = links + venster.cx;	// in pixels from the world
+	const int boven = origin.y - RandGrootte / 2, onder  = boven + venster.cy;
+
+	from_x	= max (from_x, links  * k / f - k);
+	to_x	= min (to_x,   rechts * k / f + k);
+	from_y	= max (from_y, wereld.hoogte () - 1 - onder * k / f - k);
+	to_y	= min (to_y,   wereld.hoogte () - 1 - boven * k / f + k);
+	return from_x <= to_x && from_y <= to_y;
+}
+
+void ROBOT :: zoomNaar (int z)
+{
+	int verste = AantalZoomPixels - 1;
+	for (int zijde = 1; zijde < max (wereld.breedte (), wereld.hoogte ()); zijde *= 2)
+		verste++;
+	z = max (0, min (z, verste));
+	if (z == zoom || overzicht != 0)
+		return;
+
+	Canvas canvas (karelsWereld());
+	const GPOINT origin	= canvas.getOrigin ();
+	const GSIZE  venster	= karelsWereld().getWindowSize ();
+	canvas.setPenColour	(WhiteRGB);
+	canvas.fillRectangle (origin, GPOINT (origin.x + venster.cx, origin.y + venster.cy));
+
+	zoom = z;
+	toonWereld (false, true);
+}
+
+GPOINT ROBOT :: schermPos (int sin_richting, int cos_richting, int hoek_nr)
+{
+	const int f = veldPixels ();
+	const double schaal = f / (2.0 * SteenGrootte);
+	const GPOINT oorsprong = schermPunt (0, 0);
+	double x = wereld.x () * f + (cos_richting * hoeken[hoek_nr][0] - sin_richting * hoeken[hoek_nr][1]) * schaal;
+	double y = wereld.y () * f + (sin_richting * hoeken[hoek_nr][0] + cos_richting * hoeken[hoek_nr][1]) * schaal;
+	return GPOINT (oorsprong.x + int (x), oorsprong.y - int (y));
+}
+
+//	herteken shows the fields around Charles after a primitive, and pauses.
 void ROBOT :: herteken ()
+{
+	if (!toont ())
+		return;
+
+	SpoorStuk spoor ("herteken");
+
+	markeer		(wereld.x (), wereld.y ());
+	presenteer	(stap_voor_stap || stap_tijd * BeeldenPerSeconde >= 1000);	// every step is shown when it pauses for at least a frame
+	pauze		();
+}
+
+//	toonWereld draws the whole world after it has been changed by a generator; it takes the place
+//	of an overview that is shown.
+void ROBOT :: toonWereld (bool wissen, bool met_robot)
+{
+	if (overzicht != 0)
+	{
+		toonOverzicht (0);
+		return;
+	}
+	if (!toont ())
+		return;
+
+	Canvas canvas (karelsWereld());
+	tellerPlus (T_WereldTekenen);
+	if (wissen)
+		wisWereldDeel (canvas, 0, 0, wereld.breedte ()-1, wereld.hoogte ()-1);
+	tekenWereld (canvas);
+	if (met_robot)
+		tekenRobot (canvas);
+	if (statistiek_zichtbaar)
+		tekenStatistiek (canvas);
+	if (met_robot)
+	{
+		vuil = false;
+		laatste_beeld = klok ();
+		stopBeeldTimer ();
+	}
+}
+
+//	ververs redraws the counters after a primitive, at most five times per second.
+void ROBOT :: ververs (Canvas& canvas)
+{
+	if (statistiek_zichtbaar && GetTickCount () - statistiek_getoond >= 200)
+		tekenStatistiek (canvas);
+}
+
+void ROBOT :: tekenStatistiek (Canvas& canvas)
+{
+	const int aantal_regels = 5;
+	ostringstream regels [aantal_regels];
+	const ResourceUsage gebruik = karelsWereld ().GetResourceUsage ();
+
+	regels [0] << "steps " << tellerTotaal (T_Stap) << "   turns " << tellerTotaal (T_Draai)
+			   << "   balls " << tellerTotaal (T_PakBal) << "/" << tellerTotaal (T_LegBal) << "   tests " << tellerTotaal (T_Test);
+	regels [1] << "redraws " << tellerTotaal (T_Herteken) << "   world redraws " << tellerTotaal (T_WereldTekenen)
+			   << "   fields drawn " << tellerTotaal (T_VeldTekenen);
+	regels [2] << "canvases " << tellerTotaal (T_Canvas) << "   draw ops " << tellerTotaal (T_Tekenen)
+			   << "   GDI calls " << tellerTotaal (T_GdiAanroep) << "   colour switches " << tellerTotaal (T_KleurWissel);
+	if (stap_tijd > 0)
+		regels [3] << "speed " << 1000 / stap_tijd << " steps/s";
+	else
+		regels [3] << "speed unlimited";
+	if (turbo_aan)
+		regels [3] << "   turbo";
+	if (stap_voor_stap)
+		regels [3] << "   single step";
+	regels [4] << "GDI objects " << gebruik.gdi_objects << " (kernel " << gebruik.kernel_objects << ", colours " << gebruik.colours
+			   << ")   USER objects " << gebruik.user_objects << "   heap " << gebruik.heap_blocks << " blocks, " << gebruik.heap_bytes / 1024 << " KB";
+
+	const int hoogte = canvas.getFontHeight ();
+	int breedte = 0;
+	for (int r = 0; r < aantal_regels; r++)
+		breedte = max (breedte, canvas.getTextWidth (regels [r].str ().c_str ()));
+
+	canvas.setPenColour	(WhiteRGB);
+	canvas.fillRectangle (GPOINT (RandGrootte, RandGrootte), GPOINT (RandGrootte + breedte + 8, RandGrootte + aantal_regels * hoogte + 8));
+	canvas.setPenColour	(BlackRGB);
+	for (int r = 0; r < aantal_regels; r++)
+	{
+		canvas.setPenPos (GPOINT (RandGrootte + 4, RandGrootte + 4 + r * hoogte));
+		canvas.drawText	 (regels [r].str ().c_str ());
+	}
+	statistiek_getoond = GetTickCount ();
+}
+
+static void schrijfStatistiek ()
+{
+	ofstream uit ("statistics.txt");
+	schrijfTellers (uit);
+}
+
+void ROBOT :: toonStatistiek (bool aan)
+{
+	static bool bij_afsluiten = false;
+	if (aan && !bij_afsluiten)				// the counters are written to statistics.txt when the program ends
+	{
+		atexit (schrijfStatistiek);
+		bij_afsluiten = true;
+	}
+
+	statistiek_zichtbaar = aan;
+	toonWereld (true, true);
+}
+
+static const GPOINT OverzichtHoek (RandGrootte, RandGrootte);	// the top-left corner of an overview in the window
+
+static void tekenOverzichtBeeld (TimerId, void *robot)
+{
+	Canvas canvas (karelsWereld());
+	((ROBOT*) robot) -> tekenOverzicht (canvas);
+}
+
+/*	toonOverzicht shows o in the window instead of the world, until toonOverzicht (0) or until
+	the world is drawn again in full (by a generator, reset, ...). A timer draws the tiles that
+	changed OverzichtBeeldenPerSeconde times per second. Meanwhile the primitives of Charles
+	do not draw.
+*/
+void ROBOT :: toonOverzicht (Overzicht *o)
+{
+	Canvas canvas (karelsWereld());
+	if (overzicht != 0)
+	{
+		karelsWereld().removeTimer (overzicht_timer);
+		const GSIZE grootte = overzicht -> grootte ();
+		canvas.setPenColour	(WhiteRGB);
+		canvas.fillRectangle (OverzichtHoek, GPOINT (OverzichtHoek.x + grootte.cx, OverzichtHoek.y + grootte.cy));
+	}
+	else if (o != 0)
+		wisWereldDeel (canvas, 0, 0, wereld.breedte ()-1, wereld.hoogte ()-1);
+
+	overzicht = o;
+	if (overzicht != 0)
+	{
+		overzicht_timer = karelsWereld().addTimer (1000.0 / OverzichtBeeldenPerSeconde, tekenOverzichtBeeld, this);
+		tekenOverzicht (canvas);
+	}
+	else
+		toonWereld (true, true);
+}
+
+void ROBOT :: tekenOverzicht (Canvas& canvas)
+{
+	if (overzicht != 0)
+		overzicht -> teken (canvas, OverzichtHoek);
+}
+
+/*	campagneOverzicht asks for a program file in the language of Vertaler.h, and runs the program
+	on OverzichtWerelden generated caves at once, in a campaign (Campagne.h) with an evaluator
+	thread per world, while the window shows all of them (Overzicht.h). The threads run the
+	program OverzichtPlak instructions at a time and show their world after every slice; they
+	pause in between, so that one can follow the worlds. The run of a world ends when the
+	program stops, after OverzichtMaximum instructions, or at an illegal action or a program
+	error; its tile then shows where it ended. The overview stays until the world of Charles
+	is drawn again. Escape stops the campaign, as it interrupts Charles.
+*/
+const int		OverzichtWerelden	= 24;
+const int		OverzichtKolommen	= 5;
+const int		OverzichtVeld		= 2;			// pixels per field
+const int		OverzichtPlak		= 100;
+const int		OverzichtRust		= 10;			// milliseconds between two slices
+const long long	OverzichtMaximum	= 200000;
+
+void ROBOT :: campagneOverzicht ()
+{
+	static unique_ptr<Overzicht> getoond;			// the overview of the last campaign
+
+	char bestand [FileSelector :: MAXFileName] = "";
+	if (!FileSelector (karelsWereld()).get (bestand))
+		return;
+	Programma programma;
+	try
+	{
+		programma = optimaliseer (Vertaler :: laad (bestand));
+	}
+	catch (ProgrammaFout& fout)
+	{
+		fout.report ();
+		return;
+	}
+
+	unique_ptr<Overzicht> nieuw (new Overzicht (OverzichtWerelden, OverzichtKolommen, WereldBreedte, WereldHoogte, OverzichtVeld));
+	Overzicht& tegels = *nieuw;
+	const Campagne campagne = { GrotWereld, OverzichtWerelden, (unsigned long long) GetTickCount (), WereldBreedte, WereldHoogte,
+								1, OverzichtWerelden, OverzichtWerelden };
+	atomic<bool> stoppen (false), klaar (false);
+
+	const Evaluatie evalueer = [&] (int nummer, Wereld& w, Arena& arena)
+	{
+		try
+		{
+			Machine machine (programma, w, &arena);
+			tegels.toon (nummer, w);
+			for (long long over = OverzichtMaximum; over > 0 && !machine.gestopt () && !stoppen.load (memory_order_relaxed); )
+			{
+				over -= machine.voerUit (min (over, (long long) OverzichtPlak));
+				tegels.toon (nummer, w);
+				this_thread::sleep_for (chrono::milliseconds (OverzichtRust));
+			}
+		}
+		catch (...)		// IllegaleActie or ProgrammaFout: the run of this world ends here
+		{
+		}
+		tegels.toon (nummer, w);
+	};
+
+	toonOverzicht (nieuw.get ());
+	getoond = move (nieuw);
+	thread uitvoerder ([&] { voerCampagneUit (campagne, evalueer); klaar = true; });
+	try
+	{
+		while (!klaar)
+			pomp (1000.0 / OverzichtBeeldenPerSeconde);
+	}
+	catch (...)
+	{
+		stoppen = true;
+		uitvoerder.join ();
+		throw;
+	}
+	uitvoerder.join ();
+
+	Canvas canvas (karelsWereld());
+	tekenOverzicht (canvas);
+}
+
+void ROBOT :: hertekenDeel (int from_x, int from_y, int to_x, int to_y)
 {
 	Canvas canvas (karelsWereld());
-	herteken (canvas);
+	wisWereldDeel 	(canvas, from_x, from_y, to_x, to_y);
+	tekenWereldDeel	(canvas, from_x, from_y, to_x, to_y);
 }
 
+//	When the world is zoomed out far Charles is a red square on his block.
 void ROBOT :: tekenRobot (Canvas &canvas)
 {
+	if (dichtheidZoom ())
+	{
+		const int niveau = blokNiveau (), f = veldPixels ();
+		const GPOINT hoek = celHoek (wereld.x () >> niveau, wereld.y () >> niveau);
+		const int rand = max (KarelPixels - f, 0) / 2;
+		canvas.setPenColour		(RedRGB);
+		canvas.fillRectangle	(GPOINT (hoek.x - rand, hoek.y - rand), GPOINT (hoek.x + f + rand, hoek.y + f + rand));
+		return;
+	}
+
 	int sin_richting = 99, cos_richting =99 ;   // door Ger P: onmogelijke beginwaarden ivm compiler-warning
 
-	switch (huidige_richting)
+	switch (wereld.richting ())
 	{
 		case Oost:
 			sin_richting = -1;
@@ -330,8 +921,9 @@ void  ROBOT :: tekenRobot ()
 
 void  ROBOT :: tekenSteen (Canvas &canvas, int x, int y)
 {
-	const GPOINT lo = naarGPOINT (x * SteenGrootte - SteenGrootte / 2, y * SteenGrootte - SteenGrootte / 2);
-	canvas.fillRectangle (lo, GPOINT (lo.x + SteenGrootte,lo.y - SteenGrootte));
+	const int steen = veldPixels () / 2;
+	const GPOINT lo = schermPunt (2 * x - 1, 2 * y - 1);
+	canvas.fillRectangle (lo, GPOINT (lo.x + steen,lo.y - steen));
 }
 
 void  ROBOT :: tekenMuur (Canvas &canvas, int x, int y)
@@ -339,16 +931,16 @@ void  ROBOT :: tekenMuur (Canvas &canvas, int x, int y)
 	canvas.setPenColour 	(BlueRGB);
 
 	tekenSteen (canvas, x*2, y*2);
-	if (x < WereldBreedte - 1 && Wereld [x+1][y] == Muur)
+	if (x < wereld.breedte () - 1 && wereld.veld (x+1, y) == Muur)
 		tekenSteen (canvas, x*2+1, y*2);
-	if (y < WereldHoogte - 1 && Wereld [x][y+1] == Muur)
+	if (y < wereld.hoogte () - 1 && wereld.veld (x, y+1) == Muur)
 		tekenSteen (canvas, x*2, y*2+1);
 }
 
 void  ROBOT :: tekenLeegVeld (Canvas &canvas, int x, int y)
 {
 	canvas.setPenColour (BlackRGB);
-	canvas.setPenPos	(naarGPOINT (x*2*SteenGrootte, y*2*SteenGrootte));
+	canvas.setPenPos	(schermPunt (4 * x, 4 * y));
 	canvas.drawPOINT	();
 }
 
@@ -356,19 +948,30 @@ void  ROBOT :: tekenBal (Canvas &canvas, int x, int y)
 {
 	canvas.setPenColour (GreenRGB);
 
-	const GPOINT lo = naarGPOINT (x * 2 * SteenGrootte - BalGrootte / 2, y * 2 * SteenGrootte - BalGrootte / 2);
-	canvas.fillOval (lo, GPOINT (lo.x + BalGrootte,lo.y - BalGrootte));
+	const int bal = BalGrootte * veldPixels () / (2 * SteenGrootte);
+	const GPOINT midden = schermPunt (4 * x, 4 * y);
+	const GPOINT lo (midden.x - bal / 2, midden.y + bal / 2);
+	canvas.fillOval (lo, GPOINT (lo.x + bal,lo.y - bal));
 }
 
 void ROBOT :: tekenWereld (Canvas& canvas)
 {
-	tekenWereldDeel (canvas, 0, 0, WereldBreedte-1, WereldHoogte-1);
+	tekenWereldDeel (canvas, 0, 0, wereld.breedte ()-1, wereld.hoogte ()-1);
 }
 
 void ROBOT :: wisWereldDeel (Canvas &canvas, int from_x, int from_y, int to_x, int to_y)
 {
-	const GPOINT lo = naarGPOINT (from_x * 2 * SteenGrootte, from_y * 2 * SteenGrootte - SteenGrootte / 2);
-	const GPOINT rb = naarGPOINT (to_x * 2 * SteenGrootte, to_y * 2 * SteenGrootte + SteenGrootte / 2);
+	SpoorStuk spoor ("wisWereldDeel");
+
+	GPOINT lo = schermPunt (4 * from_x, 4 * from_y - 1);
+	GPOINT rb = schermPunt (4 * to_x, 4 * to_y + 1);
+	if (dichtheidZoom ())
+	{
+		const int niveau = blokNiveau (), f = veldPixels ();
+		lo = celHoek (from_x >> niveau, to_y >> niveau);
+		rb = celHoek (to_x >> niveau, from_y >> niveau);
+		rb = GPOINT (rb.x + f, rb.y + f);
+	}
 
 	canvas.setPenColour	(WhiteRGB);
 	canvas.fillRectangle (lo, rb);
@@ -376,10 +979,20 @@ void ROBOT :: wisWereldDeel (Canvas &canvas, int from_x, int from_y, int to_x, i
 
 void ROBOT :: tekenWereldDeel (Canvas &canvas, int from_x, int from_y, int to_x, int to_y)
 {
+	SpoorStuk spoor ("tekenWereldDeel");
+
+	if (!zichtbaarDeel (canvas, from_x, from_y, to_x, to_y))
+		return;
+	if (dichtheidZoom ())
+	{
+		tekenDichtheid (canvas, from_x, from_y, to_x, to_y);
+		return;
+	}
 
 	for (int b = from_x; b <= to_x; b++)
 	{	for (int h = from_y; h <= to_y; h++)
-		{	switch (Wereld [b][h])
+		{	tellerPlus (T_VeldTekenen);
+			switch (wereld.veld (b, h))
 			{
 				case Muur:
 					tekenMuur		(canvas, b, h);
@@ -395,64 +1008,72 @@ void ROBOT :: tekenWereldDeel (Canvas &canvas, int from_x, int from_y, int to_x,
 	}
 }
 
-void ROBOT :: nieuweWereld (const char wereld [])
+//	mengKleur is the pixel of a block with the given density of walls and of balls: white, mixed
+//	with the blue of the walls and the green of the balls in proportion.
+static DWORD mengKleur (int muren, int ballen)
 {
-	ifstream doolhof;
-
-	doolhof.open (wereld);
+	const int leeg = max (255 - muren - ballen, 0);
+	return (leeg << 16) | (min (leeg + ballen, 255) << 8) | min (leeg + muren, 255);
+}
 
-	if (doolhof.fail ())
-		throw IllegaleActie (IA_Open);
-	else
+/*	tekenDichtheid draws the blocks over the fields from (from_x,from_y) to (to_x,to_y), and a
+	block around them where Charles may have left his square, into dichtheid_beeld and copies
+	that to the canvas at once. Only the blocks above changed fields are computed again.
+*/
+void ROBOT :: tekenDichtheid (Canvas &canvas, int from_x, int from_y, int to_x, int to_y)
+{
+	const int niveau = blokNiveau (), f = veldPixels ();
+	if (niveau > 0)
+		dichtheid.werkBij (wereld);
+	const int cellen_breed = niveau > 0 ? dichtheid.breedte (niveau) : wereld.breedte ();
+	const int cellen_hoog  = niveau > 0 ? dichtheid.hoogte (niveau)  : wereld.hoogte ();
+	const int lx = max ((from_x >> niveau) - 1, 0), rx = min ((to_x >> niveau) + 1, cellen_breed - 1);
+	const int ly = max ((from_y >> niveau) - 1, 0), ry = min ((to_y >> niveau) + 1, cellen_hoog - 1);
+	const GSIZE deel ((rx - lx + 1) * f, (ry - ly + 1) * f);
+
+	if (!dichtheid_beeld || dichtheid_beeld -> getSize ().cx < deel.cx || dichtheid_beeld -> getSize ().cy < deel.cy)
 	{
-		int i, r, x_bal, y_bal, hori_muren, verti_muren;
-
-		doolhof >> x_pos >> y_pos >> r >> x_bal >> y_bal >> hori_muren >> verti_muren;
-
-		huidige_richting = Richting (r);
-
-		maakWereldLeeg ();
-		rechthoek (0,0,WereldBreedte,WereldHoogte,Muur,Wereld);
-
-		Wereld [x_bal][y_bal] = Bal;
-
-		for (i = 0; i < hori_muren; i++)
-		{	int x, y, d;
-			doolhof >> x >> y >> d;
-			for (int j = 0; j < d; j++)
-				Wereld [x+j][y] = Muur;
-		}
-		for (i = 0; i < verti_muren; i++)
-		{	int x, y, d;
-			doolhof >> x >> y >> d;
-			for (int j = 0; j < d; j++)
-				Wereld [x][y+j] = Muur;
+		const GSIZE oud = dichtheid_beeld ? dichtheid_beeld -> getSize () : GSIZE (0, 0);
+		dichtheid_beeld.reset (new BitmapTarget (GSIZE (max (deel.cx, oud.cx), max (deel.cy, oud.cy))));
+	}
+	DWORD *const pixels = dichtheid_beeld -> pixels ();
+	const int regel = dichtheid_beeld -> getSize ().cx;
+
+	for (int cx = lx; cx <= rx; cx++)
+		for (int cy = ly; cy <= ry; cy++)
+		{
+			DWORD pixel;
+			if (niveau > 0)
+				pixel = mengKleur (dichtheid.muren (niveau, cx, cy), dichtheid.ballen (niveau, cx, cy));
+			else
+				switch (wereld.veld (cx, cy))
+				{
+					case Muur:	pixel = mengKleur (255, 0);	break;
+					case Bal:	pixel = mengKleur (0, 255);	break;
+					default:	pixel = mengKleur (0, 0);	break;
+				}
+			DWORD *rij = pixels + (ry - cy) * f * regel + (cx - lx) * f;
+			for (int r = 0; r < f; r++, rij += regel)
+				fill (rij, rij + f, pixel);
 		}
+	tellerPlus (T_VeldTekenen, (rx - lx + 1) * (ry - ly + 1));
+	canvas.drawImage (*dichtheid_beeld, celHoek (lx, ry), deel);
+}
 
-		doolhof.close ();
-
-		Canvas canvas (karelsWereld());
-		wisWereldDeel	(canvas, 0, 0, WereldBreedte-1, WereldHoogte-1);
+void ROBOT :: nieuweWereld (const char wereld_naam [])
+{
+	SpoorStuk spoor ("nieuweWereld");
 
-		tekenWereld	(canvas);
-		tekenRobot	(canvas);
-	}
+	wereld.laad (wereld_naam);
+	toonWereld (true, true);
 }
 
 void ROBOT :: reset()
 {
-	huidige_richting = Oost;
-	x_pos = xInit;
-	y_pos = yInit;
-
-	maakWereldLeeg ();
-	rechthoek (0,0,WereldBreedte,WereldHoogte,Muur,Wereld);
+	SpoorStuk spoor ("reset");
 
-	Canvas canvas (karelsWereld());
-	wisWereldDeel	(canvas, 0, 0, WereldBreedte-1, WereldHoogte-1);
-
-	tekenWereld	(canvas);
-	tekenRobot	(canvas);
+	wereld.reset ();
+	toonWereld (true, true);
 }
 
 Robot& Karel ()			// delaratie van Karel als robot
@@ -464,8 +1085,73 @@ Robot& Karel ()			// delaratie van Karel als robot
 void RobotGUI :: Window (const RECT& area)
 {
 	Canvas canvas(karelsWereld());
+	if (Karel().overzichtGetoond ())
+	{
+		Karel().tekenOverzicht (canvas);
+		return;
+	}
 	Karel().tekenWereld	(canvas);
 	Karel().tekenRobot	(canvas);
+	if (Karel().statistiekZichtbaar ())
+		Karel().tekenStatistiek (canvas);
+}
+
+/*	The speed can be changed with the keyboard, also while Charles runs:
+	+ and - double and halve the speed, t switches turbo mode, the space bar switches
+	single step mode, Enter performs the next step, and Escape interrupts Charles; it
+	does nothing when no menu command runs. i and o zoom in and out.
+*/
+void RobotGUI :: Keyboard (const KEYINFO& key_info)
+{
+	if (key_info.isASCII)
+		switch (key_info.keyCode)
+		{
+			case '+':	faster ();		break;
+			case '-':	slower ();		break;
+			case 't':
+			case 'T':	turbo ();		break;
+			case ' ':	single_step ();	break;
+			case 'i':
+			case 'I':	zoom_in ();		break;
+			case 'o':
+			case 'O':	zoom_out ();	break;
+		}
+	else if (key_info.keyCode == WinReturnKey)
+		next_step ();
+	else if (key_info.keyCode == WinEscapeKey && CommandsRunning () > 0)
+		Karel().onderbreek ();
+}
+
+/*	An interrupted command (IA_Onderbroken) is reported and ends only that command, not the
+	program. A command that found the window closed (IA_Gesloten) ends silently. When the outermost command ends, however it ends, an Escape it did not see any
+	more is forgotten and a begin_edit it did not commit is committed (eindeOpdracht).
+*/
+void RobotGUI :: MenuCommand (MenuCallBack command)
+{
+	const bool buitenste = CommandsRunning () == 1;
+	try
+	{
+		command ();
+	}
+	catch (IllegaleActie& actie)
+	{
+		if (buitenste)
+			Karel().eindeOpdracht ();
+		if (actie.actie () == IA_Gesloten)
+			return;
+		if (actie.actie () != IA_Onderbroken)
+			throw;
+		actie.report ();
+		return;
+	}
+	catch (...)
+	{
+		if (buitenste)
+			Karel().eindeOpdracht ();
+		throw;
+	}
+	if (buitenste)
+		Karel().eindeOpdracht ();
 }
 
 RobotGUI :: RobotGUI()
@@ -492,12 +1178,18 @@ void leg_bal		() { Karel().legBal(); }
 bool muur_voor		() { return Karel().muurVoor(); }
 bool noord			() { return Karel().noord(); }
 
-void rust       	(int n) { Karel().rust(n); }
+void rust       	(double n) { Karel().rust(n); }
+void stappen_per_seconde (double n) { Karel().stappenPerSeconde(n); }
 
 void maakWereldLeeg () { Karel().maakWereldLeeg(); }
 void nieuweWereld	(const char wereld [])  { Karel().nieuweWereld(wereld); }
 void reset			() { Karel().reset(); }
+#ifdef KAREL_BENCHMARK
+void stop 			() { throw EindeRoutine (0); }
+void einde_routine	(int code) { throw EindeRoutine (code); }
+#else
 void stop 			() { karelsWereld().Stop();}
+#endif
 
 
 // For English version:
@@ -511,24 +1203,18 @@ void put_ball		() { Karel().legBal(); }
 bool in_front_of_wall    () { return Karel().muurVoor(); }
 bool north			() { return Karel().noord(); }
 
-void rest			(int n) { Karel().rust(n); }
+void rest			(double n) { Karel().rust(n); }
+void steps_per_second (double n) { Karel().stappenPerSeconde(n); }
 void makeWorldEmpty () { Karel().maakWereldLeeg(); }
 void newWorld	    (const char wereld [])  { Karel().nieuweWereld(wereld); }
 
 
-int kies3 ()
-{
-	return rand () % 3 + 1;
-}
-
 // void veeg_schoon ()        { reset(); }
 
 // toegevoegd door Ger Paulussen:
-void stappen (int aantal_stappen)
-{
-	for (int teller = 1 ; teller <= aantal_stappen ; teller = teller + 1)
-		stap () ;
-}
+void stappen (int aantal_stappen) { Karel().stappen(aantal_stappen); }
+void naar_muur		() { Karel().naarMuur(); }
+void walk_to_wall	() { Karel().naarMuur(); }
 
 void teken_ballenlijn ( int aantal_ballen )	// toegevoegd door Ger
 {
@@ -539,171 +1225,121 @@ void teken_ballenlijn ( int aantal_ballen )	// toegevoegd door Ger
 	}
 }
 
-void ROBOT :: plaatsRechthoek ( int links, int onder, int breedte, int hoogte )
+/*	The generators change the world and mark the fields they changed (gewijzigd). Between
+	beginWijziging and voerWijzigingDoor the changes are only collected: the changed fields
+	are drawn in one frame when the outermost transaction is committed. Outside a transaction
+	every generator is a transaction of its own. The hash of the world (Wereld::hash) is
+	computed at most once per transaction, the first time it is asked for.
+*/
+void ROBOT :: beginWijziging ()
 {
-	for (int hor = links; hor<=links+breedte; hor++)
-	{
-		Wereld [hor][onder]        = Muur ;
-		Wereld [hor][onder+hoogte] = Muur ;
-	};
+	wijzigingen++;
+}
 
-	for (int vert = onder; vert<=onder+hoogte; vert++)
-	{
-		Wereld [links][vert]         = Muur ;
-		Wereld [links+breedte][vert] = Muur ;
-	};
+void ROBOT :: voerWijzigingDoor ()
+{
+	if (wijzigingen > 0 && --wijzigingen > 0)
+		return;
 
-	Canvas canvas (karelsWereld());
-	tekenWereld (canvas);
+	SpoorStuk spoor ("voerWijzigingDoor");
+	if (toont ())
+		presenteer (true);
 }
 
-void ROBOT :: maakMuur ( int links, int onder, int aantal, bool horizontaal )
+/*	eindeOpdracht is called when the outermost menu command returns or throws. A transaction
+	that an exception left open is committed, so that later changes are drawn again, and an
+	interrupt that no routine picked up is dropped.
+*/
+void ROBOT :: eindeOpdracht ()
 {
-    if (horizontaal)
-    {
-        for (int x = links ; x <= links + aantal ; x++)
-        {
-            Wereld [x][onder] = Muur ;
-        }
-    }
-    else
-    {
-        for (int y = onder; y <= onder+aantal ; y++)
-        {
-            Wereld[links][y] = Muur ;
-        }
-    }
-    Canvas canvas (karelsWereld()) ;
-    tekenWereld (canvas) ;
-    tekenRobot  (canvas) ;
+	onderbroken = false;
+	if (wijzigingen > 0)
+	{	wijzigingen = 1;
+		voerWijzigingDoor ();
+	}
 }
 
-void ROBOT :: maakBallenSnoer ()	// toegevoegd door Ger
+void ROBOT :: gewijzigd (int lx, int ly, int rx, int ry)
 {
-	for (int hor = 1; hor<= WereldBreedte - 2; hor++)
-	{
-		Wereld [hor][1] = Bal ;
-		Wereld [hor][WereldHoogte - 2] = Bal ;
-	};
+	if (toont ())
+		markeerGebied (lx, ly, rx, ry);
+	if (wijzigingen == 0)
+		voerWijzigingDoor ();
+}
 
-	for (int vert = 2; vert<=WereldHoogte - 2; vert++)
-	{
-		Wereld [1][vert] = Bal ;
-		Wereld [WereldBreedte - 2][vert] = Bal ;
-	};
+void ROBOT :: plaatsRechthoek ( int links, int onder, int breedte, int hoogte )
+{
+	SpoorStuk spoor ("plaatsRechthoek");
 
-	Canvas canvas (karelsWereld());
-	tekenWereld (canvas);
+	wereld.plaatsRechthoek (links, onder, breedte, hoogte) ;
+	gewijzigd (links, onder, links + breedte, onder + hoogte) ;
 }
 
-bool voorkeurLinks ()
+void ROBOT :: maakMuur ( int links, int onder, int aantal, bool horizontaal )
 {
-	return kies3 () == 1;
+	SpoorStuk spoor ("maakMuur");
+
+	wereld.maakMuur (links, onder, aantal, horizontaal) ;
+	if (horizontaal)
+		gewijzigd (links, onder, links + aantal, onder) ;
+	else
+		gewijzigd (links, onder, links, onder + aantal) ;
 }
 
-bool voorkeurRechts ()
+void ROBOT :: maakBallenSnoer ()	// toegevoegd door Ger
 {
-	return kies3 () == 3;
+	SpoorStuk spoor ("maakBallenSnoer");
+
+	wereld.maakBallenSnoer () ;
+	gewijzigd (0, 0, wereld.breedte () - 1, wereld.hoogte () - 1) ;
 }
 
 void ROBOT :: maakBallenChaos ()	// toegevoegd door Ger
 {
-	const int aantal_keuzes	= 9;
-	const int aantal_rijen		= aantal_keuzes * 2 + 1;
-
-	int ballen [aantal_rijen];
-	int i;
-	for (i = 0; i < aantal_rijen; i++)
-		ballen [i] = 0;
-
-	for (i = 0; i < 40; i++)
-	{	int bal = aantal_keuzes;
-		for (int j = 0; j < aantal_keuzes ; j++)
-			if (voorkeurLinks ())
-				bal--;
-			else if (voorkeurRechts ())
-				bal++;
-		ballen [bal]++;
-	}
-
-	for (i = 0; i < aantal_rijen; i++)
-		for (int j = 0; j < ballen [i]; j++)
-			Wereld [WereldBreedte - j - 2][WereldHoogte - i] = Bal;
+	SpoorStuk spoor ("maakBallenChaos");
 
-	Canvas canvas (karelsWereld());
-	tekenWereld (canvas);
+	wereld.maakBallenChaos () ;
+	gewijzigd (0, 0, wereld.breedte () - 1, wereld.hoogte () - 1) ;
 }
 
 void ROBOT :: maakBallenPad ()			// toegevoegd door Peter
 {
-	maakWereldLeeg ();
-	rechthoek (0,0,WereldBreedte,WereldHoogte,Muur,Wereld);
-
-	for (int ix = 1; ix < WereldBreedte-8; ix++)					Wereld[ix][WereldHoogte-2]  = Bal;
-	for (int iy = WereldHoogte-2; iy > WereldHoogte/2; iy--)		Wereld[WereldBreedte-8][iy] = Bal;
-	for (int ix = WereldBreedte-8; ix >= 1; ix--)	                Wereld[ix][WereldHoogte/2]  = Bal;
-	for (int iy = WereldHoogte/2; iy >= 4; iy--)					Wereld[1][iy] = Bal;
-	for (int ix = 1; ix <= WereldBreedte/3; ix++)		    		Wereld[ix][4]               = Bal;
-	for (int iy = 4; iy <= WereldHoogte * 2 / 3; iy++)				Wereld[WereldBreedte/3][iy] = Bal;
+	SpoorStuk spoor ("maakBallenPad");
 
-	x_pos = 1;
-	y_pos = WereldHoogte-2;
-
-	Canvas canvas (karelsWereld());
-	wisWereldDeel (canvas, 0, 0, WereldBreedte-1, WereldHoogte-1);
-	tekenWereld (canvas);
-	tekenRobot  (canvas);
+	wereld.maakBallenPad () ;
+	gewijzigd (0, 0, wereld.breedte () - 1, wereld.hoogte () - 1) ;
 }
 
 void ROBOT :: grotwand (Richting richting)    // toegevoegd door Peter
 {
-    const int marge       = WereldHoogte / 3 ;
-    const int max_breedte = WereldBreedte / 10 ;
-
-    for (int ix = 2; ix <= WereldBreedte-3; )
-    {
-        const int breedte = rand() % (min (max_breedte, WereldBreedte - ix - 2)) + 1 ;
-        const int dy = rand() % marge + 2 ;
-        int y ;
-        if (richting == Noord)
-        {
-            y = dy ;
-        }
-        else
-        {
-            y = WereldHoogte - dy - 1 ;
-        }
-        for (int i=1; i <= breedte; i++)
-        {
-            Wereld[ix][y] = Muur ;
-            ix++ ;
-        }
-    }
+	wereld.grotwand (richting) ;
 }
 
 void ROBOT :: maakGrot ()               // toegevoegd door Peter
 {
-    maakWereldLeeg () ;
-    rechthoek (0,0, WereldBreedte,WereldHoogte,Muur,Wereld);
-    grotwand (Noord) ;
-    grotwand (Zuid) ;
-	x_pos = 1;
-	y_pos = WereldHoogte-2;
-    Canvas canvas (karelsWereld());
-    wisWereldDeel (canvas, 0,0, WereldBreedte-1, WereldHoogte-1);
-    tekenWereld (canvas) ;
-    tekenRobot  (canvas) ;
+	SpoorStuk spoor ("maakGrot");
+
+	wereld.maakGrot () ;
+	gewijzigd (0, 0, wereld.breedte () - 1, wereld.hoogte () - 1) ;
+}
+
+void ROBOT :: maakDoolhof (DoolhofSoort soort, unsigned long long zaad)
+{
+	SpoorStuk spoor ("maakDoolhof");
+
+	::maakDoolhof (wereld, soort, zaad) ;
+	gewijzigd (0, 0, wereld.breedte () - 1, wereld.hoogte () - 1) ;
 }
 
 void ROBOT :: creeerBal (int x, int y)
 {
-    if (x >= 0 && x < WereldBreedte && y >= 0 && y < WereldHoogte)
-    {
-        Wereld[x][y] = Bal;
-        Canvas canvas (karelsWereld());
-        tekenWereld (canvas);
-        tekenRobot  (canvas);
-    }
+	SpoorStuk spoor ("creeerBal");
+
+	if (x >= 0 && x < wereld.breedte () && y >= 0 && y < wereld.hoogte ())
+	{
+		wereld.creeerBal (x, y);
+		gewijzigd (x, y, x, y);
+	}
 }
 
 // For English version:
@@ -715,7 +1351,42 @@ void make_chaos_with_balls  ()  { Karel().maakBallenChaos (); }
 void make_path_with_balls   ()  { Karel().maakBallenPad (); }
 void make_cave              ()  { Karel().maakGrot (); }
 void make_labyrinth         ()  { Karel().nieuweWereld ( "labyrinth" ) ; }
+void make_maze              (unsigned long long seed, DoolhofSoort kind) { Karel().maakDoolhof (kind, seed); }
 void create_ball            (int x, int y) { Karel().creeerBal(x,y); }
+void begin_edit             ()  { Karel().beginWijziging (); }
+void commit_edit            ()  { Karel().voerWijzigingDoor (); }
 
 void steps (int number_of_steps) { stappen ( number_of_steps ) ; }
 void draw_line_with_balls ( int number_of_steps )  { teken_ballenlijn ( number_of_steps ); }	// toegevoegd door Ger
+
+// For benchmarks and tools:
+Wereld& wereldVanKarel ()	{ return Karel().model (); }
+void herteken_deel (int from_x, int from_y, int to_x, int to_y) { Karel().hertekenDeel (from_x, from_y, to_x, to_y); }
+void teken_modus (bool aan)				{ Karel().tekenModus (aan); }
+long long aantal_acties ()				{ return Karel().aantalActies (); }
+void actie_limiet (long long n)			{ Karel().actieLimiet (n); }
+unsigned long long world_hash ()		{ return Karel().model ().hash (); }
+void toon_overzicht (Overzicht *overzicht)	{ Karel().toonOverzicht (overzicht); }
+
+void faster ()							{ Karel().sneller (); }
+void slower ()							{ Karel().langzamer (); }
+void turbo ()							{ Karel().turbo (!Karel().turboAan ()); }
+void single_step ()						{ Karel().stapVoorStap (!Karel().stapVoorStapAan ()); }
+void next_step ()						{ Karel().volgendeStap (); }
+
+void show_statistics ()					{ Karel().toonStatistiek (!Karel().statistiekZichtbaar ()); }
+void campaign_overview ()				{ Karel().campagneOverzicht (); }
+void zoom_in ()							{ Karel().zoomIn (); }
+void zoom_out ()						{ Karel().zoomUit (); }
+
+void record_trace ()
+{
+	if (!spoorLoopt ())
+		startSpoor ();
+	else
+	{
+		stopSpoor ();
+		ofstream uit ("trace.json");
+		schrijfChromeTrace (uit);
+	}
+}
@@ -1,4 +1,8 @@
 #include "gui_kernel.h"
+#include "Wereld.h"
+#include "Doolhof.h"
+
+class Overzicht;
 
 /*
 	Robot is a library to draw and manipulate a simple robot in a window.
@@ -18,7 +22,11 @@ extern void leg_bal		();
 extern bool muur_voor		();
 extern bool noord			();
 
-extern void rust			(int n);
+extern void stappen		(int aantal_stappen);
+extern void naar_muur		();		// while (!muur_voor ()) stap ();
+
+extern void rust			(double n);		// pause n milliseconds after each step
+extern void stappen_per_seconde (double n);
 
 extern void maakWereldLeeg ();
 extern void nieuweWereld	(const char wereld []);
@@ -36,7 +44,10 @@ extern void put_ball	() ;
 extern bool in_front_of_wall    () ;
 extern bool north		() ;
 
-extern void rest		(int n) ;
+extern void walk_to_wall	() ;	// while (!in_front_of_wall ()) step ();
+
+extern void rest		(double n) ;	// pause n milliseconds after each step
+extern void steps_per_second (double n) ;
 extern void makeWorldEmpty () ;
 extern void newWorld	(const char wereld []) ;
 
@@ -49,34 +60,28 @@ const int SteenGrootte	= 6;
 const int BalGrootte	= 11;
 const int RobotGrootte	= 18;
 const int RandGrootte	= 12;
-const int WereldBreedte = 50;
-const int WereldHoogte	= 30;
-
 const int SCREENWIDTH	= WereldBreedte * 2 * SteenGrootte + RandGrootte;
 const int SCREENHEIGHT	= WereldHoogte * 2 * SteenGrootte + RandGrootte;
 
 const int dInit = 60;
 
+//	The maximum number of frames per second; the changes made by faster primitives are combined.
+const int BeeldenPerSeconde = 60;
+
+//	The number of frames per second of an overview of many worlds (toon_overzicht).
+const int OverzichtBeeldenPerSeconde = 10;
+
 class RobotGUI : public GUI
 {
 public:
 	virtual void Window (const RECT& area);
+	virtual void Keyboard (const KEYINFO& key_info);
+	virtual void MenuCommand (MenuCallBack command);
 	RobotGUI();
 };
 
 extern RobotGUI& karelsWereld();
 
-enum IllegaleActies { IA_Karel, IA_Stap, IA_PakBal, IA_LegBal, IA_Open} ;
-
-class IllegaleActie
-{
-public:
-	IllegaleActie (IllegaleActies ia) : _actie (ia) {}
-	void report () ;
-private:
-	IllegaleActies _actie;
-} ;
-
 // For English version:
 extern void steps ( int ) ;
 extern void draw_line_with_balls ( int ) ;
@@ -88,3 +93,43 @@ extern void make_labyrinth () ;
 extern void make_path_with_balls () ;			// toegevoegd door Peter Achten 8 sept 09
 extern void create_ball (int x, int y) ;        // toegevoegd door Peter Achten 21 aug 13
 extern void make_cave () ;                      // toegevoegd door Peter Achten 10 sept 14
+extern void make_maze (unsigned long long seed, DoolhofSoort kind = Backtracker) ;	// a new perfect maze in the whole world; the same seed gives the same maze
+extern void begin_edit () ;                     // the changes of the world until commit_edit are drawn in one frame
+extern void commit_edit () ;
+extern void faster () ;                         // doubles the speed of Charles
+extern void slower () ;                         // halves the speed of Charles
+extern void turbo () ;                          // switches turbo mode on/off: no drawing and no pauses at all
+extern void single_step () ;                    // switches single step mode on/off: each step waits for next_step
+extern void next_step () ;
+extern void show_statistics () ;                // switches the overlay of counters and resource usage on/off; the counters are written to statistics.txt at exit
+extern void record_trace () ;                   // starts recording a timeline; the next call writes it to trace.json (Chrome trace format)
+extern void campaign_overview () ;              // runs a program file on many generated caves at once, and shows them all
+extern void zoom_in () ;                        // a field is drawn larger, up to 2 * SteenGrootte pixels
+extern void zoom_out () ;                       // a field is drawn smaller; far out a pixel is a block of fields (Dichtheid.h)
+
+// For benchmarks and tools:
+extern Wereld& wereldVanKarel () ;                          // the headless world Charles lives in
+extern void herteken_deel (int from_x, int from_y, int to_x, int to_y) ;  // wipe and redraw part of the world
+extern void teken_modus (bool aan) ;                        // false: primitives neither draw nor pause
+extern long long aantal_acties () ;                         // number of primitives performed by Charles
+extern void actie_limiet (long long n) ;                    // IllegaleActie (IA_Limiet) after n more primitives; 0 = no limit
+extern unsigned long long world_hash () ;                   // identifies the fields of the world (Wereld::hash)
+extern void toon_overzicht (Overzicht *overzicht) ;         // the window shows the tiles of overzicht (Overzicht.h) instead of the world; 0: the world again
+
+#ifdef KAREL_BENCHMARK
+//	The Benchmark target runs the routines of Charles.cpp one after the other in one process,
+//	so there stop () and exit (code) end only the running routine: they throw EindeRoutine.
+#include <cstdlib>
+
+class EindeRoutine
+{
+public:
+	EindeRoutine (int code) : _code (code) {}
+	int code () const { return _code; }
+private:
+	int _code;
+} ;
+
+extern void einde_routine (int code) ;
+#define exit(code) einde_routine (code)
+#endif
@@ -0,0 +1,112 @@
+#include <chrono>
+
+/*
+	Spoor: the ring buffer is a fixed array of slots. A writer claims a slot with a single
+	fetch_add on the write position and publishes it with a sequence number (a seqlock), so
+	a reader can skip slots that are being overwritten while it copies them.
+*/
+
+#include "Spoor.h"
+
+using namespace std;
+
+atomic<bool> spoor_aan (false);
+
+static const unsigned long long spoor_capaciteit = 1 << 16;		// must be a power of two
+
+struct SpoorGebeurtenis
+{
+	atomic<unsigned long long>	volgnummer;		// position + 1 when complete; 0 while being written
+	atomic<const char *>		naam;
+	atomic<long long>			begin_ns;
+	atomic<long long>			duur_ns;
+	atomic<int>					thread;
+} ;
+
+static SpoorGebeurtenis				spoor_ring [spoor_capaciteit];
+static atomic<unsigned long long>	spoor_positie (0);
+static atomic<int>					spoor_threads (0);
+
+static const chrono::steady_clock::time_point spoor_begin = chrono::steady_clock::now ();
+
+long long spoorKlok_ns ()
+{
+	return chrono::duration_cast<chrono::nanoseconds> (chrono::steady_clock::now () - spoor_begin).count ();
+}
+
+static int spoorThread ()
+{
+	static thread_local int nummer = ++spoor_threads;
+	return nummer;
+}
+
+void spoorVoegToe (const char naam [], long long begin_ns, long long eind_ns)
+{
+	const unsigned long long positie = spoor_positie.fetch_add (1, memory_order_relaxed);
+	SpoorGebeurtenis& g = spoor_ring [positie & (spoor_capaciteit - 1)];
+
+	g.volgnummer.store (0, memory_order_relaxed);
+	atomic_thread_fence (memory_order_release);
+	g.naam.store     (naam,               memory_order_relaxed);
+	g.begin_ns.store (begin_ns,           memory_order_relaxed);
+	g.duur_ns.store  (eind_ns - begin_ns, memory_order_relaxed);
+	g.thread.store   (spoorThread (),     memory_order_relaxed);
+	g.volgnummer.store (positie + 1, memory_order_release);
+}
+
+void startSpoor ()
+{
+	for (unsigned long long i = 0; i < spoor_capaciteit; i++)
+		spoor_ring [i].volgnummer.store (0, memory_order_relaxed);
+	spoor_positie.store (0, memory_order_relaxed);
+	spoor_aan.store (true, memory_order_release);
+}
+
+void stopSpoor ()
+{
+	spoor_aan.store (false, memory_order_release);
+}
+
+bool spoorLoopt ()
+{
+	return spoor_aan.load (memory_order_relaxed);
+}
+
+//	microseconden writes a time in ns as microseconds with three decimals, the unit of the trace format.
+static void microseconden (ostream& uit, long long ns)
+{
+	uit << ns / 1000 << '.' << (char) ('0' + ns / 100 % 10) << (char) ('0' + ns / 10 % 10) << (char) ('0' + ns % 10);
+}
+
+//	JSON strings: span names are string literals without quotes or backslashes.
+void schrijfChromeTrace (ostream& uit)
+{
+	const unsigned long long eind  = spoor_positie.load (memory_order_acquire);
+	const unsigned long long begin = eind > spoor_capaciteit ? eind - spoor_capaciteit : 0;
+	bool eerste = true;
+
+	uit << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+	for (unsigned long long positie = begin; positie < eind; positie++)
+	{
+		SpoorGebeurtenis& g = spoor_ring [positie & (spoor_capaciteit - 1)];
+
+		if (g.volgnummer.load (memory_order_acquire) != positie + 1)
+			continue;
+		const char *naam     = g.naam.load     (memory_order_relaxed);
+		const long long b_ns = g.begin_ns.load (memory_order_relaxed);
+		const long long d_ns = g.duur_ns.load  (memory_order_relaxed);
+		const int thread     = g.thread.load   (memory_order_relaxed);
+		atomic_thread_fence (memory_order_acquire);
+		if (g.volgnummer.load (memory_order_relaxed) != positie + 1)
+			continue;										// overwritten while being copied
+
+		uit << (eerste ? "" : ",\n")
+		    << "{\"name\":\"" << naam << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread << ",\"ts\":";
+		microseconden (uit, b_ns);
+		uit << ",\"dur\":";
+		microseconden (uit, d_ns);
+		uit << "}";
+		eerste = false;
+	}
+	uit << "\n]}\n";
+}
@@ -0,0 +1,57 @@
+#ifndef SPOOR_H
+#define SPOOR_H
+
+#include <atomic>
+#include <ostream>
+
+/*
+	Spoor records timed spans of the simulation and the rendering in a lock-free ring
+	buffer and exports them in the Chrome trace format (chrome://tracing, ui.perfetto.dev).
+
+	A span is measured by a SpoorStuk on the stack:
+
+		void ROBOT :: herteken (Canvas &canvas)
+		{
+			SpoorStuk spoor ("herteken");
+			...
+		}
+
+	Recording is off by default; a SpoorStuk then costs one relaxed load. When the ring
+	is full the oldest spans are overwritten. Names must be string literals (only the
+	pointer is stored).
+
+	startSpoor			clears the ring and starts recording
+	stopSpoor			stops recording
+	schrijfChromeTrace	writes the spans in the ring as Chrome trace JSON; it may be called
+						while other threads are still recording
+*/
+
+extern std::atomic<bool> spoor_aan;
+
+extern void			startSpoor			();
+extern void			stopSpoor			();
+extern bool			spoorLoopt			();
+extern void			schrijfChromeTrace	(std::ostream& uit);
+extern long long	spoorKlok_ns		();
+extern void			spoorVoegToe		(const char naam [], long long begin_ns, long long eind_ns);
+
+class SpoorStuk
+{
+public:
+	explicit SpoorStuk (const char stuk_naam [])
+		: naam (spoor_aan.load (std::memory_order_relaxed) ? stuk_naam : 0), begin_ns (naam ? spoorKlok_ns () : 0)
+	{}
+	~SpoorStuk ()
+	{
+		if (naam)
+			spoorVoegToe (naam, begin_ns, spoorKlok_ns ());
+	}
+private:
+	SpoorStuk (const SpoorStuk&);
+	const SpoorStuk& operator= (const SpoorStuk&);
+
+	const char	*naam;
+	long long	begin_ns;
+} ;
+
+#endif
@@ -0,0 +1,91 @@
+#include <mutex>
+
+/*
+	Tellers: the blocks of all threads are kept in a list. A block is created by the first
+	count of a thread; when the thread ends its counts are moved to the retired block.
+*/
+
+#include "Tellers.h"
+
+using namespace std;
+
+static const char *teller_namen [AantalTellers] =
+{	"steps", "turns", "balls_picked", "balls_put", "tests"
+,	"redraws", "world_redraws", "fields_drawn"
+,	"canvases", "draw_operations", "gdi_calls", "colour_switches"
+} ;
+
+static mutex		tellers_slot;
+static TellerBlok	*alle_tellers = NULL;		// the blocks of the running threads
+static TellerBlok	gestopte_threads;			// the counts of threads that have finished
+
+TellerBlok :: TellerBlok ()
+	: volgende (NULL)
+{
+	for (int t = 0; t < AantalTellers; t++)
+		waarde [t].store (0, memory_order_relaxed);
+}
+
+//	Eigenaar registers the block of a thread and retires it when the thread ends.
+struct Eigenaar
+{
+	TellerBlok	*blok;
+
+	Eigenaar ()
+		: blok (new TellerBlok ())
+	{
+		lock_guard<mutex> slot (tellers_slot);
+		blok -> volgende = alle_tellers;
+		alle_tellers = blok;
+	}
+
+	~Eigenaar ()
+	{
+		lock_guard<mutex> slot (tellers_slot);
+		for (int t = 0; t < AantalTellers; t++)
+			gestopte_threads.waarde [t].fetch_add (blok -> waarde [t].load (memory_order_relaxed), memory_order_relaxed);
+		for (TellerBlok **b = &alle_tellers; *b != NULL; b = &(*b) -> volgende)
+			if (*b == blok)
+			{	*b = blok -> volgende;
+				break;
+			}
+		delete blok;
+	}
+} ;
+
+TellerBlok& tellersVanDezeThread ()
+{
+	static thread_local Eigenaar eigenaar;
+	return *eigenaar.blok;
+}
+
+unsigned long long tellerTotaal (Teller teller)
+{
+	lock_guard<mutex> slot (tellers_slot);
+	unsigned long long totaal = gestopte_threads.waarde [teller].load (memory_order_relaxed);
+	for (TellerBlok *b = alle_tellers; b != NULL; b = b -> volgende)
+		totaal += b -> waarde [teller].load (memory_order_relaxed);
+	return totaal;
+}
+
+const char* tellerNaam (Teller teller)
+{
+	return teller_namen [teller];
+}
+
+void schrijfTellers (ostream& uit)
+{
+	for (int t = 0; t < AantalTellers; t++)
+		uit << tellerNaam (Teller (t)) << ' ' << tellerTotaal (Teller (t)) << '\n';
+}
+
+void resetTellers ()
+{
+	lock_guard<mutex> slot (tellers_slot);
+	for (int t = 0; t < AantalTellers; t++)
+	{
+		gestopte_threads.waarde [t].store (0, memory_order_relaxed);
+		for (TellerBlok *b = alle_tellers; b != NULL; b = b -> volgende)
+			b -> waarde [t].store (0, memory_order_relaxed);
+	}
+}
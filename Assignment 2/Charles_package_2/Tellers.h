@@ -0,0 +1,51 @@
+#ifndef TELLERS_H
+#define TELLERS_H
+
+#include <atomic>
+#include <ostream>
+
+/*
+	Tellers are cheap event counters for the hot paths of Charles and the gui_kernel.
+
+	Every thread counts in its own block, so tellerPlus is a plain load and store without
+	locking or cache-line sharing. tellerTotaal adds the blocks of all threads (including
+	threads that have finished) on demand. schrijfTellers writes all totals, one per line.
+*/
+
+enum Teller
+{	T_Stap				//	ROBOT primitives
+,	T_Draai
+,	T_PakBal
+,	T_LegBal
+,	T_Test				//	muurVoor, bovenopBal, noord
+,	T_Herteken			//	partial redraw around the robot
+,	T_WereldTekenen		//	full redraw of the world
+,	T_VeldTekenen		//	single fields drawn by tekenWereldDeel
+,	T_Canvas			//	Canvas objects created (each one a view on the drawing context of a render target)
+,	T_Tekenen			//	Canvas drawing operations
+,	T_GdiAanroep		//	GDI calls made by the Canvas operations
+,	T_KleurWissel		//	setPenColour calls that really changed the colour
+,	AantalTellers
+} ;
+
+struct TellerBlok
+{
+	std::atomic<unsigned long long>	waarde [AantalTellers];
+	TellerBlok						*volgende;
+
+	TellerBlok ();
+} ;
+
+extern TellerBlok&			tellersVanDezeThread	();
+extern unsigned long long	tellerTotaal			(Teller teller);
+extern const char*			tellerNaam				(Teller teller);
+extern void					schrijfTellers			(std::ostream& uit);
+extern void					resetTellers			();
+
+inline void tellerPlus (Teller teller, unsigned long long n = 1)
+{
+	std::atomic<unsigned long long>& w = tellersVanDezeThread ().waarde [teller];
+	w.store (w.load (std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+#endif
@@ -0,0 +1,71 @@
+#ifndef TOEVAL_H
+#define TOEVAL_H
+
+#include <cstdlib>
+
+/*
+	Toeval is a small random generator (xorshift64*): the same zaad gives the same numbers
+	on every platform, and it does not depend on rand ().
+
+	The generators of Wereld draw their numbers with willekeurig (). That is rand (), as in
+	the original, so that srand still selects a world; but the state of rand () is shared by
+	all threads (or, with some C libraries, kept per thread), so threads that generate worlds
+	next to each other get worlds that depend on timing. Such a thread gives the generators
+	a source of their own with EigenToeval: while it exists, willekeurig () on that thread
+	draws from a Toeval with its zaad, and the same zaad gives the same world.
+*/
+
+class Toeval
+{
+public:
+	explicit Toeval (unsigned long long zaad)
+	{
+		//	splitmix64 spreads similar seeds over the whole state; the state must not be 0
+		unsigned long long z = zaad + 0x9E3779B97F4A7C15ULL;
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+		toestand = (z ^ (z >> 31)) | 1;
+	}
+
+	unsigned long long	volgende	()
+	{
+		toestand ^= toestand >> 12;
+		toestand ^= toestand << 25;
+		toestand ^= toestand >> 27;
+		return toestand * 2685821657736338717ULL;
+	}
+	unsigned			onder		(unsigned n) { return (unsigned) (((volgende () >> 32) * n) >> 32); }	//	0 <= result < n
+
+private:
+	unsigned long long	toestand;
+} ;
+
+inline Toeval*& toevalVanThread ()
+{
+	static thread_local Toeval *toeval = 0;
+	return toeval;
+}
+
+class EigenToeval
+{
+public:
+	explicit EigenToeval (unsigned long long zaad) : toeval (zaad), vorige (toevalVanThread ()) { toevalVanThread () = &toeval; }
+	~EigenToeval () { toevalVanThread () = vorige; }
+
+private:
+	EigenToeval (const EigenToeval&);
+	EigenToeval& operator = (const EigenToeval&);
+
+	Toeval		toeval;
+	Toeval		*vorige;		//	EigenToeval can be nested
+} ;
+
+//	willekeurig gives a number from the Toeval of the thread (0 <= result < 32768, the smallest
+//	RAND_MAX allowed) or else from rand () as it is.
+inline int willekeurig ()
+{
+	Toeval *const toeval = toevalVanThread ();
+	return toeval != 0 ? (int) toeval -> onder (32768) : rand ();
+}
+
+#endif
@@ -0,0 +1,403 @@
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <sstream>
+
+/*
+	Vertaler compiles in a single pass: the Ontleder below reads the program token by token
+	and emits bytecode immediately. A procedure is emitted where it is defined, behind a
+	jump over its body, and is called through a label, so that it can be used before it is
+	defined.
+*/
+
+#include "Vertaler.h"
+
+using namespace std;
+
+enum Soort { S_Naam, S_Getal, S_Teken, S_Einde };
+
+struct Symbool
+{
+	Soort	soort;
+	string	tekst;
+	int		regel;
+} ;
+
+struct Procedure
+{
+	Label	label;
+	bool	gedefinieerd;
+	int		regel;			//	the first line that uses or defines it
+} ;
+
+class Ontleder
+{
+public:
+	Ontleder (const string& tekst, const string& naam) : tekst (tekst), naam (naam), positie (0), regel (1) { lees (); }
+
+	Programma vertaal ();
+
+private:
+	const string&		tekst;
+	const string&		naam;
+	size_t				positie;
+	int					regel;
+	Symbool				huidig;
+
+	Programma				programma;
+	map<string, Procedure>	procedures;
+	bool					in_procedure;
+
+	void	lees		();
+	void	fout		(const string& melding, int op_regel = 0);
+	bool	is			(const char teken []) const { return huidig.soort != S_Getal && huidig.tekst == teken; }
+	void	verwacht	(const char teken []);
+	void	haakjes		();
+
+	struct Voorwaarde
+	{
+		Opcode	test;
+		bool	niet;
+	} ;
+
+	void	procedure	();
+	void	blok		();
+	void	opdracht	();
+	Voorwaarde	voorwaarde	();
+	void	springAls	(const Voorwaarde& v, bool waar, Label l);
+	Label	procedureLabel (const string& naam);
+} ;
+
+void Ontleder :: fout (const string& melding, int op_regel)
+{
+	ostringstream uit;
+	uit << naam << ":" << (op_regel > 0 ? op_regel : huidig.regel) << ": " << melding;
+	throw ProgrammaFout (uit.str ());
+}
+
+//	lees reads the next token into huidig, skipping white space and comments.
+void Ontleder :: lees ()
+{
+	for (;;)
+	{
+		while (positie < tekst.size () && isspace ((unsigned char) tekst [positie]))
+			if (tekst [positie++] == '\n')
+				regel++;
+		if (tekst.compare (positie, 2, "//") == 0)
+		{
+			while (positie < tekst.size () && tekst [positie] != '\n')
+				positie++;
+		}
+		else if (tekst.compare (positie, 2, "/*") == 0)
+		{
+			const size_t einde = tekst.find ("*/", positie + 2);
+			if (einde == string::npos)
+			{
+				huidig.regel = regel;
+				fout ("comment is not closed");
+			}
+			for (; positie < einde; positie++)
+				if (tekst [positie] == '\n')
+					regel++;
+			positie = einde + 2;
+		}
+		else
+			break;
+	}
+
+	huidig.regel = regel;
+	if (positie >= tekst.size ())
+	{
+		huidig.soort = S_Einde;
+		huidig.tekst = "end of program";
+		return;
+	}
+
+	const size_t begin = positie;
+	const unsigned char c = tekst [positie];
+	if (isalpha (c) || c == '_')
+	{
+		while (positie < tekst.size () && (isalnum ((unsigned char) tekst [positie]) || tekst [positie] == '_'))
+			positie++;
+		huidig.soort = S_Naam;
+	}
+	else if (isdigit (c))
+	{
+		while (positie < tekst.size () && isdigit ((unsigned char) tekst [positie]))
+			positie++;
+		huidig.soort = S_Getal;
+	}
+	else
+	{
+		positie++;
+		huidig.soort = S_Teken;
+	}
+	huidig.tekst.assign (tekst, begin, positie - begin);
+}
+
+void Ontleder :: verwacht (const char teken [])
+{
+	if (!is (teken))
+		fout (string ("'") + teken + "' expected instead of '" + huidig.tekst + "'");
+	lees ();
+}
+
+//	haakjes skips the optional '()' after a name.
+void Ontleder :: haakjes ()
+{
+	if (is ("("))
+	{
+		lees ();
+		verwacht (")");
+	}
+}
+
+//	primitief and test look up the instruction of a name; AantalOpcodes if there is none.
+static Opcode primitief (const string& naam)
+{
+	if		(naam == "step"		|| naam == "stap")		return OP_Stap;
+	else if (naam == "turn_left"	|| naam == "linksom")	return OP_Linksom;
+	else if (naam == "turn_right"	|| naam == "rechtsom")	return OP_Rechtsom;
+	else if (naam == "get_ball"	|| naam == "pak_bal")	return OP_PakBal;
+	else if (naam == "put_ball"	|| naam == "leg_bal")	return OP_LegBal;
+	else
+		return AantalOpcodes;
+}
+
+static Opcode test (const string& naam)
+{
+	if		(naam == "in_front_of_wall" || naam == "muur_voor")	return OP_MuurVoor;
+	else if (naam == "on_ball"			 || naam == "op_bal")		return OP_OpBal;
+	else if (naam == "north"			 || naam == "noord")		return OP_Noord;
+	else
+		return AantalOpcodes;
+}
+
+static bool sleutelwoord (const string& naam)
+{
+	return naam == "procedure" || naam == "while" || naam == "if" || naam == "else"
+		|| naam == "repeat" || naam == "not" || naam == "stop" || naam == "return";
+}
+
+Label Ontleder :: procedureLabel (const string& naam)
+{
+	map<string, Procedure>::iterator p = procedures.find (naam);
+	if (p == procedures.end ())
+	{
+		Procedure nieuw = { programma.nieuwLabel (), false, huidig.regel };
+		p = procedures.insert (make_pair (naam, nieuw)).first;
+	}
+	return p -> second.label;
+}
+
+Programma Ontleder :: vertaal ()
+{
+	in_procedure = false;
+	while (huidig.soort != S_Einde)
+		if (is ("procedure"))
+			procedure ();
+		else
+			opdracht ();
+
+	for (map<string, Procedure>::const_iterator p = procedures.begin (); p != procedures.end (); p++)
+		if (!p -> second.gedefinieerd)
+			fout ("procedure '" + p -> first + "' is used but never defined", p -> second.regel);
+
+	programma.klaar ();
+	return programma;
+}
+
+void Ontleder :: procedure ()
+{
+	if (in_procedure)
+		fout ("procedures can not be nested");
+	lees ();
+	if (huidig.soort != S_Naam || sleutelwoord (huidig.tekst))
+		fout ("name of the procedure expected instead of '" + huidig.tekst + "'");
+
+	if (primitief (huidig.tekst) != AantalOpcodes || test (huidig.tekst) != AantalOpcodes)
+		fout ("'" + huidig.tekst + "' is a primitive of Charles and can not be redefined");
+
+	const Label label = procedureLabel (huidig.tekst);
+	Procedure& p = procedures [huidig.tekst];
+	if (p.gedefinieerd)
+		fout ("procedure '" + huidig.tekst + "' is defined twice");
+	p.gedefinieerd = true;
+	lees ();
+	haakjes ();
+
+	const Label na = programma.nieuwLabel ();
+	programma.spring (na);
+	programma.plaats (label);
+	in_procedure = true;
+	blok ();
+	in_procedure = false;
+	programma.keer ();
+	programma.plaats (na);
+}
+
+void Ontleder :: blok ()
+{
+	verwacht ("{");
+	while (!is ("}"))
+	{
+		if (huidig.soort == S_Einde)
+			fout ("'}' expected at the end of the program");
+		if (is ("procedure"))
+			fout ("procedures can only be defined outside blocks");
+		opdracht ();
+	}
+	lees ();
+}
+
+//	voorwaarde reads a condition: a test, possibly negated.
+Ontleder::Voorwaarde Ontleder :: voorwaarde ()
+{
+	if (is ("("))
+	{
+		lees ();
+		const Voorwaarde v = voorwaarde ();
+		verwacht (")");
+		return v;
+	}
+	if (is ("not") || is ("!"))
+	{
+		lees ();
+		Voorwaarde v = voorwaarde ();
+		v.niet = !v.niet;
+		return v;
+	}
+	const Voorwaarde v = { test (huidig.tekst), false };
+	if (huidig.soort != S_Naam || v.test == AantalOpcodes)
+		fout ("test expected instead of '" + huidig.tekst + "'");
+	lees ();
+	haakjes ();
+	return v;
+}
+
+//	springAls emits the test of v and a jump to l that is taken when v is 'waar'.
+void Ontleder :: springAls (const Voorwaarde& v, bool waar, Label l)
+{
+	programma.voegToe (v.test);
+	if (waar != v.niet)
+		programma.springAls (l);
+	else
+		programma.springAlsNiet (l);
+}
+
+void Ontleder :: opdracht ()
+{
+	if (is (";"))
+	{
+		lees ();
+		return;
+	}
+	if (huidig.soort != S_Naam)
+		fout ("statement expected instead of '" + huidig.tekst + "'");
+
+	if (is ("while"))
+	{
+		//	the test is placed after the body, so that every round takes a single jump
+		lees ();
+		const Voorwaarde v = voorwaarde ();
+		const Label lichaam = programma.nieuwLabel (), toets = programma.nieuwLabel ();
+		programma.spring (toets);
+		programma.plaats (lichaam);
+		blok ();
+		programma.plaats (toets);
+		springAls (v, true, lichaam);
+	}
+	else if (is ("if"))
+	{
+		lees ();
+		const Voorwaarde v = voorwaarde ();
+		const Label anders = programma.nieuwLabel ();
+		springAls (v, false, anders);
+		blok ();
+		if (is ("else"))
+		{
+			lees ();
+			const Label einde = programma.nieuwLabel ();
+			programma.spring (einde);
+			programma.plaats (anders);
+			if (is ("if"))
+				opdracht ();
+			else
+				blok ();
+			programma.plaats (einde);
+		}
+		else
+			programma.plaats (anders);
+	}
+	else if (is ("repeat"))
+	{
+		lees ();
+		if (huidig.soort != S_Getal)
+			fout ("number expected after 'repeat' instead of '" + huidig.tekst + "'");
+		const long n = strtol (huidig.tekst.c_str (), NULL, 10);
+		if (n > 1000000000L)
+			fout ("repeat count is too large");
+		lees ();
+		if (n == 0)
+		{	//	the body is checked but not executed
+			const Label na = programma.nieuwLabel ();
+			programma.spring (na);
+			blok ();
+			programma.plaats (na);
+		}
+		else
+		{
+			const Label lichaam = programma.nieuwLabel ();
+			programma.teller ((int) n);
+			programma.plaats (lichaam);
+			blok ();
+			programma.herhaal (lichaam);
+		}
+	}
+	else if (is ("stop"))
+	{
+		lees ();
+		haakjes ();
+		programma.stop ();
+	}
+	else if (is ("return"))
+	{
+		lees ();
+		programma.keer ();
+	}
+	else if (is ("else"))
+		fout ("'else' without 'if'");
+	else if (is ("not"))
+		fout ("'not' can only be used in a condition");
+	else
+	{
+		const string naam = huidig.tekst;
+		if (test (naam) != AantalOpcodes)
+			fout ("'" + naam + "' is a test; use it in 'if' or 'while'");
+		const Opcode op = primitief (naam);
+		if (op != AantalOpcodes)
+			programma.voegToe (op);
+		else
+			programma.roep (procedureLabel (naam));
+		lees ();
+		haakjes ();
+	}
+}
+
+Programma Vertaler :: vertaal (const string& tekst, const string& naam)
+{
+	Ontleder ontleder (tekst, naam);
+	return ontleder.vertaal ();
+}
+
+Programma Vertaler :: laad (const string& bestand)
+{
+	ifstream invoer (bestand.c_str (), ios::in | ios::binary);
+	if (invoer.fail ())
+		throw ProgrammaFout ("It was not possible to open the program " + bestand + ".");
+
+	ostringstream tekst;
+	tekst << invoer.rdbuf ();
+	return vertaal (tekst.str (), bestand);
+}
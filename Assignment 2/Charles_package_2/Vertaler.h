@@ -0,0 +1,44 @@
+#ifndef VERTALER_H
+#define VERTALER_H
+
+#include <string>
+
+#include "Programma.h"
+
+/*
+	Vertaler compiles robot programs written in a small text language to Karel bytecode
+	(Programma.h), so that programs can be run without recompiling the C++ project.
+
+	program		::= { procedure | statement }
+	procedure	::= 'procedure' name block
+	block		::= '{' { statement } '}'
+	statement	::= primitive | name | 'stop' | 'return'
+				 |  'while' condition block
+				 |  'if' condition block [ 'else' ( block | if-statement ) ]
+				 |  'repeat' number block
+	condition	::= [ 'not' | '!' ] test  |  '(' condition ')'
+
+	The primitives are step, turn_left, turn_right, get_ball and put_ball, the tests are
+	in_front_of_wall, on_ball and north; the Dutch names (stap, linksom, muur_voor, ...)
+	can be used as well. A name may be followed by '()' and a statement by ';'.
+	A procedure may be called before it is defined; it returns at its end or at 'return'.
+	The statements outside procedures form the main program. Comments are written as in C++.
+
+		procedure turn_around { turn_left turn_left }
+
+		while not in_front_of_wall { step }
+		turn_around
+		repeat 3 { step put_ball }
+
+	vertaal compiles a text, laad compiles a file. A mistake in the program raises a
+	ProgrammaFout whose message starts with "name:line: ".
+*/
+
+class Vertaler
+{
+public:
+	static Programma	vertaal		(const std::string& tekst, const std::string& naam = "program");
+	static Programma	laad		(const std::string& bestand);
+} ;
+
+#endif
@@ -0,0 +1,119 @@
+#ifndef WACHTRIJ_H
+#define WACHTRIJ_H
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+/*
+	Wachtrij is a bounded queue that any number of threads can put into and take from at the
+	same time, without locks (the queue of Dmitry Vyukov). The slots form a ring; every slot
+	has a volgnummer that tells whose turn it is:
+
+	*	volgnummer == positie			the slot is free for the writer that claims positie
+	*	volgnummer == positie + 1		the slot holds the element for the reader of positie
+
+	A writer claims the next write position with a compare-exchange, moves its element into
+	the slot and then publishes it (release); a reader does the same on the read position and
+	hands the slot back to the writer one round later. So threads only contend on the two
+	positions, and an element is owned by exactly one thread at a time.
+
+	probeerIn and probeerUit never wait: they return false when the queue is full or empty.
+	Waiting (back-pressure on a full queue, a consumer without work) is up to the caller.
+	The capacity is rounded up to a power of two.
+*/
+
+template <class T>
+class Wachtrij
+{
+public:
+	explicit Wachtrij (size_t capaciteit);
+
+	bool	probeerIn		(T& element);		//	moves element into the queue
+	bool	probeerUit		(T& element);		//	moves the oldest element out of the queue
+	size_t	capaciteit		() const { return masker + 1; }
+
+private:
+	struct Plaats
+	{
+		std::atomic<size_t>	volgnummer;
+		T					element;
+	} ;
+
+	Wachtrij (const Wachtrij&);
+	Wachtrij& operator = (const Wachtrij&);
+
+	std::vector<Plaats>	plaatsen;
+	size_t				masker;
+	char				tussen1 [64];		//	the positions on cache lines of their own: writers
+	std::atomic<size_t>	schrijf;			//	and readers do not slow each other down
+	char				tussen2 [64];
+	std::atomic<size_t>	lees;
+} ;
+
+inline size_t machtVanTwee (size_t n)
+{
+	size_t m = 2;
+	while (m < n)
+		m *= 2;
+	return m;
+}
+
+template <class T>
+Wachtrij<T> :: Wachtrij (size_t capaciteit)
+	: plaatsen (machtVanTwee (capaciteit)), masker (plaatsen.size () - 1), schrijf (0), lees (0)
+{
+	for (size_t i = 0; i < plaatsen.size (); i++)
+		plaatsen [i].volgnummer.store (i, std::memory_order_relaxed);
+}
+
+template <class T>
+bool Wachtrij<T> :: probeerIn (T& element)
+{
+	size_t positie = schrijf.load (std::memory_order_relaxed);
+	for (;;)
+	{
+		Plaats& plaats = plaatsen [positie & masker];
+		const std::ptrdiff_t verschil = (std::ptrdiff_t) (plaats.volgnummer.load (std::memory_order_acquire) - positie);
+		if (verschil == 0)
+		{
+			if (schrijf.compare_exchange_weak (positie, positie + 1, std::memory_order_relaxed))
+			{
+				plaats.element = std::move (element);
+				plaats.volgnummer.store (positie + 1, std::memory_order_release);
+				return true;
+			}
+		}
+		else if (verschil < 0)
+			return false;							//	the reader of the previous round is not done: full
+		else
+			positie = schrijf.load (std::memory_order_relaxed);
+	}
+}
+
+template <class T>
+bool Wachtrij<T> :: probeerUit (T& element)
+{
+	size_t positie = lees.load (std::memory_order_relaxed);
+	for (;;)
+	{
+		Plaats& plaats = plaatsen [positie & masker];
+		const std::ptrdiff_t verschil = (std::ptrdiff_t) (plaats.volgnummer.load (std::memory_order_acquire) - (positie + 1));
+		if (verschil == 0)
+		{
+			if (lees.compare_exchange_weak (positie, positie + 1, std::memory_order_relaxed))
+			{
+				element = std::move (plaats.element);
+				plaats.volgnummer.store (positie + masker + 1, std::memory_order_release);
+				return true;
+			}
+		}
+		else if (verschil < 0)
+			return false;							//	nothing written at positie yet: empty
+		else
+			positie = lees.load (std::memory_order_relaxed);
+	}
+}
+
+#endif
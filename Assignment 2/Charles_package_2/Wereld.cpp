@@ -0,0 +1,532 @@
+#include <fstream>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+
+/*
+	Wereld is the headless world model of Charles. The primitives and generators below
+	used to live in ROBOT; they are kept here with the same behaviour so that ROBOT only
+	has to take care of drawing.
+*/
+
+#include "Wereld.h"
+#include "Toeval.h"
+
+using namespace std;
+
+const int xInit = 1;
+const Richting rInit = Oost;
+
+Wereld :: Wereld (int breedte, int hoogte, Arena *arena)
+	: wereld_breedte (breedte), wereld_hoogte (hoogte), velden (breedte * hoogte, Leeg, arena),
+	  ballen_vlak (breedte, hoogte, arena), muren_vlak (breedte, hoogte, arena),
+	  afstanden { ArenaVector<int> (arena), ArenaVector<int> (arena), ArenaVector<int> (arena), ArenaVector<int> (arena) },
+	  rij_gemeten (hoogte, false, arena), kolom_gemeten (breedte, false, arena), velden_hash (0), hash_geldig (false),
+	  gewijzigd_lx (0), gewijzigd_ly (0), gewijzigd_rx (breedte), gewijzigd_ry (hoogte),
+	  huidige_richting (rInit), x_pos (xInit), y_pos (hoogte - 2)
+{
+	rechthoek (0,0,wereld_breedte,wereld_hoogte,Muur);
+}
+
+Wereld :: Wereld (const Wereld& ander, Arena *arena)
+	: wereld_breedte (ander.wereld_breedte), wereld_hoogte (ander.wereld_hoogte), velden (ander.velden, arena),
+	  ballen_vlak (ander.ballen_vlak, arena), muren_vlak (ander.muren_vlak, arena),
+	  afstanden { ArenaVector<int> (ander.afstanden [0], arena), ArenaVector<int> (ander.afstanden [1], arena),
+				  ArenaVector<int> (ander.afstanden [2], arena), ArenaVector<int> (ander.afstanden [3], arena) },
+	  rij_gemeten (ander.rij_gemeten, arena), kolom_gemeten (ander.kolom_gemeten, arena),
+	  velden_hash (ander.velden_hash), hash_geldig (ander.hash_geldig),
+	  gewijzigd_lx (ander.gewijzigd_lx), gewijzigd_ly (ander.gewijzigd_ly), gewijzigd_rx (ander.gewijzigd_rx), gewijzigd_ry (ander.gewijzigd_ry),
+	  huidige_richting (ander.huidige_richting), x_pos (ander.x_pos), y_pos (ander.y_pos)
+{
+}
+
+void Wereld :: plaatsRobot (int x, int y, Richting r)
+{
+	x_pos = x;
+	y_pos = y;
+	huidige_richting = r;
+}
+
+void Wereld :: maakLeeg ()
+{
+	fill (velden.begin (), velden.end (), (unsigned char) Leeg);
+	ballen_vlak.wis ();
+	muren_vlak.wis ();
+	fill (rij_gemeten.begin (), rij_gemeten.end (), false);
+	fill (kolom_gemeten.begin (), kolom_gemeten.end (), false);
+	wijzig (0, 0, wereld_breedte, wereld_hoogte);
+}
+
+bool Wereld :: neemWijziging (int& lx, int& ly, int& rx, int& ry)
+{
+	if (gewijzigd_lx >= gewijzigd_rx)
+		return false;
+	lx = gewijzigd_lx; ly = gewijzigd_ly; rx = gewijzigd_rx; ry = gewijzigd_ry;
+	gewijzigd_lx = gewijzigd_rx = 0;
+	return true;
+}
+
+//	hash is FNV-1a over the size and the fields of the world, eight fields (one word) at a time;
+//	the shift mixes the high bits of every word into the low bits before the next one.
+unsigned long long Wereld :: hash () const
+{
+	if (hash_geldig)
+		return velden_hash;
+
+	const unsigned long long priem = 1099511628211ULL;
+	unsigned long long h = 14695981039346656037ULL;
+	h = (h ^ (unsigned long long) wereld_breedte) * priem;
+	h = (h ^ (unsigned long long) wereld_hoogte)  * priem;
+	size_t i = 0;
+	for (; i + 8 <= velden.size (); i += 8)
+	{
+		unsigned long long acht;
+		memcpy (&acht, &velden [i], 8);
+		h = (h ^ acht) * priem;
+		h ^= h >> 29;
+	}
+	for (; i < velden.size (); i++)
+		h = (h ^ velden [i]) * priem;
+	velden_hash = h;
+	hash_geldig = true;
+	return h;
+}
+
+//	meetRij and meetKolom count the free fields to the nearest wall, or to the edge of the world,
+//	in both directions along a row or column. The distance of a wall itself is not used.
+void Wereld :: meetRij (int y) const
+{
+	if (afstanden [West].empty ())
+	{
+		afstanden [West].resize (velden.size ());
+		afstanden [Oost].resize (velden.size ());
+	}
+	int aantal = 0;
+	for (int x = 0; x < wereld_breedte; x++)
+	{
+		afstanden [West][x * wereld_hoogte + y] = aantal;
+		aantal = (veld (x, y) == Muur) ? 0 : aantal + 1;
+	}
+	aantal = 0;
+	for (int x = wereld_breedte - 1; x >= 0; x--)
+	{
+		afstanden [Oost][x * wereld_hoogte + y] = aantal;
+		aantal = (veld (x, y) == Muur) ? 0 : aantal + 1;
+	}
+	rij_gemeten [y] = true;
+}
+
+void Wereld :: meetKolom (int x) const
+{
+	if (afstanden [Noord].empty ())
+	{
+		afstanden [Noord].resize (velden.size ());
+		afstanden [Zuid].resize (velden.size ());
+	}
+	const unsigned char *const kolom = &velden [x * wereld_hoogte];
+	int aantal = 0;
+	for (int y = 0; y < wereld_hoogte; y++)
+	{
+		afstanden [Zuid][x * wereld_hoogte + y] = aantal;
+		aantal = (kolom [y] == Muur) ? 0 : aantal + 1;
+	}
+	aantal = 0;
+	for (int y = wereld_hoogte - 1; y >= 0; y--)
+	{
+		afstanden [Noord][x * wereld_hoogte + y] = aantal;
+		aantal = (kolom [y] == Muur) ? 0 : aantal + 1;
+	}
+	kolom_gemeten [x] = true;
+}
+
+void Wereld :: vulRechthoek (int lx, int ly, int rx, int ry, Veld veld)
+{
+	if (lx >= rx || ly >= ry)
+		return;
+
+	//	a plane changes when some field gets its bit and did not have it, or the other way round;
+	//	when neither plane changes, every field already is 'veld'
+	const bool muren  = muren_vlak.ergensIn  (lx, ly, rx, ry, veld != Muur);
+	const bool ballen = ballen_vlak.ergensIn (lx, ly, rx, ry, veld != Bal);
+	if (!muren && !ballen)
+		return;
+
+	unsigned char *kolom = &velden [lx * wereld_hoogte + ly];
+	for (int x = lx; x < rx; x++, kolom += wereld_hoogte)
+		fill (kolom, kolom + (ry - ly), (unsigned char) veld);
+	if (ballen)
+		ballen_vlak.zetRechthoek (lx, ly, rx, ry, veld == Bal);
+	if (muren)
+	{
+		muren_vlak.zetRechthoek (lx, ly, rx, ry, veld == Muur);
+		fill (&rij_gemeten [ly],   &rij_gemeten [ry - 1] + 1,   false);
+		fill (&kolom_gemeten [lx], &kolom_gemeten [rx - 1] + 1, false);
+	}
+	wijzig (lx, ly, rx, ry);
+}
+
+//	AchtVelden gives for every byte of wall bits the eight fields of velden, as one word.
+struct AchtVelden
+{
+	unsigned long long	velden [256];
+
+	AchtVelden ()
+	{
+		for (int b = 0; b < 256; b++)
+		{
+			velden [b] = 0;
+			for (int i = 0; i < 8; i++)
+				velden [b] |= (unsigned long long) ((b >> i) & 1 ? Muur : Leeg) << (8 * i);
+		}
+	}
+} ;
+
+/*	laadMuren writes 'aantal' whole columns at once, for generators that compute their walls a
+	column at a time; muren has woordenPerKolom words per column. Eight fields of velden are
+	one word from a table, the wall plane takes the words as they are, and only the rows whose
+	walls change must be measured again. The bits of muren beyond the height of the world must
+	be 0. The wall plane builds its rows again per 64 columns, so it is fastest to load the
+	columns in blocks of 64, starting at a multiple of 64.
+*/
+void Wereld :: laadMuren (int x, int aantal, const unsigned long long muren [])
+{
+	static const AchtVelden acht;
+
+	const int woorden = muren_vlak.woordenPerKolom ();
+	for (int i = 0; i < aantal; i++, muren += woorden)
+	{
+		unsigned char *const kolom = &velden [(x + i) * wereld_hoogte];
+		int y = 0;
+		for (; y + 8 <= wereld_hoogte; y += 8)
+		{
+			const unsigned long long v = acht.velden [(muren [y >> 6] >> (y & 63)) & 255];
+			memcpy (kolom + y, &v, 8);
+		}
+		for (; y < wereld_hoogte; y++)
+			kolom [y] = (unsigned char) (((muren [y >> 6] >> (y & 63)) & 1) ? Muur : Leeg);
+
+		const unsigned long long *const oud = muren_vlak.kolom (x + i);
+		for (int n = 0; n < woorden; n++)
+			if (oud [n] != muren [n])
+			{
+				fill (&rij_gemeten [n * 64], &rij_gemeten [min (n * 64 + 64, wereld_hoogte) - 1] + 1, false);
+				kolom_gemeten [x + i] = false;
+			}
+	}
+	muren -= aantal * woorden;
+	muren_vlak.laadKolommen (x, aantal, muren);
+	if (ballen_vlak.ergensIn (x, 0, x + aantal, wereld_hoogte, true))
+		ballen_vlak.zetRechthoek (x, 0, x + aantal, wereld_hoogte, false);
+	wijzig (x, 0, x + aantal, wereld_hoogte);
+}
+
+void Wereld :: rechthoek (int lx, int ly, int rx, int ry, Veld veld)
+{
+	if (lx >= rx || ly >= ry)
+		return;
+	vulRij	 (ly,     lx,     rx,     veld);
+	vulRij	 (ry - 1, lx,     rx,     veld);
+	vulKolom (lx,     ly + 1, ry - 1, veld);
+	vulKolom (rx - 1, ly + 1, ry - 1, veld);
+}
+
+void Wereld :: linksom ()
+{
+	huidige_richting = (Richting) ((huidige_richting + 1) % 4);
+}
+
+void Wereld :: rechtsom ()
+{
+	huidige_richting = (Richting) ((huidige_richting + 3) % 4);
+}
+
+void Wereld :: pakBal ()
+{
+	if (bovenopBal())
+		zetVeld (x_pos, y_pos, Leeg);
+	else
+		throw IllegaleActie (IA_PakBal);
+}
+
+void Wereld :: legBal ()
+{
+	if (veld (x_pos, y_pos) == Leeg)
+		zetVeld (x_pos, y_pos, Bal);
+	else
+		throw IllegaleActie (IA_LegBal);
+}
+
+void Wereld :: stap ()
+{
+	switch (huidige_richting)
+	{
+		case Noord:
+			if (veld (x_pos, y_pos+1) == Muur)
+				throw IllegaleActie (IA_Stap);
+			else
+				y_pos++;
+			break;
+		case Oost:
+			if (veld (x_pos+1, y_pos) == Muur)
+				throw IllegaleActie (IA_Stap);
+			else
+				x_pos++;
+			break;
+		case Zuid:
+			if (veld (x_pos, y_pos-1) == Muur)
+				throw IllegaleActie (IA_Stap);
+			else
+				y_pos--;
+			break;
+		case West:
+			if (veld (x_pos-1, y_pos) == Muur)
+				throw IllegaleActie (IA_Stap);
+			else
+				x_pos--;
+			break;
+	}
+}
+
+//	stappen takes at most n steps, stopping in front of a wall, and returns the number taken.
+int Wereld :: stappen (int n)
+{
+	const int gezet = min (n, vrijVoor ());
+	if (gezet <= 0)
+		return 0;
+	switch (huidige_richting)
+	{
+		case Noord:	y_pos += gezet; break;
+		case Oost:	x_pos += gezet; break;
+		case Zuid:	y_pos -= gezet; break;
+		case West:	x_pos -= gezet; break;
+	}
+	return gezet;
+}
+
+int Wereld :: reeks (int van, int n, bool bal) const
+{
+	switch (huidige_richting)
+	{
+		case Oost:	return ballen_vlak.eersteInRij (y_pos, x_pos + van, x_pos + van + n, !bal) - (x_pos + van);
+		case West:	return (x_pos - van) - ballen_vlak.laatsteInRij (y_pos, x_pos - van - n + 1, x_pos - van + 1, !bal);
+		case Noord:	return ballen_vlak.eersteInKolom (x_pos, y_pos + van, y_pos + van + n, !bal) - (y_pos + van);
+		case Zuid:	return (y_pos - van) - ballen_vlak.laatsteInKolom (x_pos, y_pos - van - n + 1, y_pos - van + 1, !bal);
+	}
+	return 0;
+}
+
+void Wereld :: zetBallen (int van, int n, bool bal)
+{
+	const unsigned char waarde = (unsigned char) (bal ? Bal : Leeg);
+	switch (huidige_richting)
+	{
+		case Oost:
+			for (int x = x_pos + van; x < x_pos + van + n; x++)
+				velden [x * wereld_hoogte + y_pos] = waarde;
+			ballen_vlak.zetRij (y_pos, x_pos + van, x_pos + van + n, bal);
+			wijzig (x_pos + van, y_pos, x_pos + van + n, y_pos + 1);
+			break;
+		case West:
+			for (int x = x_pos - van - n + 1; x <= x_pos - van; x++)
+				velden [x * wereld_hoogte + y_pos] = waarde;
+			ballen_vlak.zetRij (y_pos, x_pos - van - n + 1, x_pos - van + 1, bal);
+			wijzig (x_pos - van - n + 1, y_pos, x_pos - van + 1, y_pos + 1);
+			break;
+		case Noord:
+			fill (&velden [x_pos * wereld_hoogte + y_pos + van], &velden [x_pos * wereld_hoogte + y_pos + van] + n, waarde);
+			ballen_vlak.zetKolom (x_pos, y_pos + van, y_pos + van + n, bal);
+			wijzig (x_pos, y_pos + van, x_pos + 1, y_pos + van + n);
+			break;
+		case Zuid:
+			fill (&velden [x_pos * wereld_hoogte + y_pos - van - n + 1], &velden [x_pos * wereld_hoogte + y_pos - van] + 1, waarde);
+			ballen_vlak.zetKolom (x_pos, y_pos - van - n + 1, y_pos - van + 1, bal);
+			wijzig (x_pos, y_pos - van - n + 1, x_pos + 1, y_pos - van + 1);
+			break;
+	}
+}
+
+bool Wereld :: muurVoor () const
+{
+	switch (huidige_richting)
+	{
+		case Noord:
+			return (veld (x_pos, y_pos+1) == Muur);
+		case Oost:
+			return (veld (x_pos+1, y_pos) == Muur);
+		case Zuid:
+			return (veld (x_pos, y_pos-1) == Muur);
+		case West:
+			return (veld (x_pos-1, y_pos) == Muur);
+		default :
+			return false ;
+	}
+}
+
+void Wereld :: reset ()
+{
+	huidige_richting = Oost;
+	x_pos = xInit;
+	y_pos = wereld_hoogte - 2;
+
+	maakLeeg ();
+	rechthoek (0,0,wereld_breedte,wereld_hoogte,Muur);
+}
+
+void Wereld :: laad (const char naam [])
+{
+	ifstream doolhof;
+
+	doolhof.open (naam);
+
+	if (doolhof.fail ())
+		throw IllegaleActie (IA_Open);
+
+	int i, r, x_bal, y_bal, hori_muren, verti_muren;
+
+	doolhof >> x_pos >> y_pos >> r >> x_bal >> y_bal >> hori_muren >> verti_muren;
+
+	huidige_richting = Richting (r);
+
+	maakLeeg ();
+	rechthoek (0,0,wereld_breedte,wereld_hoogte,Muur);
+
+	zetVeld (x_bal, y_bal, Bal);
+
+	for (i = 0; i < hori_muren; i++)
+	{	int x, y, d;
+		doolhof >> x >> y >> d;
+		vulRij (y, x, x + d, Muur);
+	}
+	for (i = 0; i < verti_muren; i++)
+	{	int x, y, d;
+		doolhof >> x >> y >> d;
+		vulKolom (x, y, y + d, Muur);
+	}
+
+	doolhof.close ();
+}
+
+
+/*****************************************************************************************
+	Generators (toegevoegd door Ger Paulussen & Peter Achten):
+*****************************************************************************************/
+
+int kies3 ()
+{
+	return willekeurig () % 3 + 1;
+}
+
+static bool voorkeurLinks ()
+{
+	return kies3 () == 1;
+}
+
+static bool voorkeurRechts ()
+{
+	return kies3 () == 3;
+}
+
+//	The corners (links,onder) and (links+breedte,onder+hoogte) are both part of the rectangle.
+void Wereld :: plaatsRechthoek ( int links, int onder, int breedte, int hoogte )
+{
+	rechthoek (links, onder, links + breedte + 1, onder + hoogte + 1, Muur) ;
+}
+
+//	A wall of aantal + 1 fields, from (links,onder) to the right or upwards.
+void Wereld :: maakMuur ( int links, int onder, int aantal, bool horizontaal )
+{
+	if (horizontaal)
+		vulRij   (onder, links, links + aantal + 1, Muur) ;
+	else
+		vulKolom (links, onder, onder + aantal + 1, Muur) ;
+}
+
+void Wereld :: maakBallenSnoer ()
+{
+	vulRij   (1,                  1, wereld_breedte - 1, Bal) ;
+	vulRij   (wereld_hoogte - 2,  1, wereld_breedte - 1, Bal) ;
+	vulKolom (1,                  2, wereld_hoogte - 1,  Bal) ;
+	vulKolom (wereld_breedte - 2, 2, wereld_hoogte - 1,  Bal) ;
+}
+
+void Wereld :: maakBallenChaos ()
+{
+	const int aantal_keuzes	= 9;
+	const int aantal_rijen	= aantal_keuzes * 2 + 1;
+
+	int ballen [aantal_rijen];
+	int i;
+	for (i = 0; i < aantal_rijen; i++)
+		ballen [i] = 0;
+
+	for (i = 0; i < 40; i++)
+	{	int bal = aantal_keuzes;
+		for (int j = 0; j < aantal_keuzes ; j++)
+			if (voorkeurLinks ())
+				bal--;
+			else if (voorkeurRechts ())
+				bal++;
+		ballen [bal]++;
+	}
+
+	//	The original wrote row i = 0 one field above the world; those balls are dropped.
+	for (i = 1; i < aantal_rijen; i++)
+	{
+		const int n = min (ballen [i], wereld_breedte - 2);		//	the fields B-2, B-3, ... of the row
+		vulRij (wereld_hoogte - i, wereld_breedte - 1 - n, wereld_breedte - 1, Bal);
+	}
+}
+
+void Wereld :: maakBallenPad ()
+{
+	maakLeeg ();
+	rechthoek (0,0,wereld_breedte,wereld_hoogte,Muur);
+
+	const int B = wereld_breedte;
+	const int H = wereld_hoogte;
+
+	vulRij   (H-2, 1,     B-8,         Bal);
+	vulKolom (B-8, H/2+1, H-1,         Bal);
+	vulRij   (H/2, 1,     B-7,         Bal);
+	vulKolom (1,   4,     H/2+1,       Bal);
+	vulRij   (4,   1,     B/3+1,       Bal);
+	vulKolom (B/3, 4,     H*2/3+1,     Bal);
+
+	x_pos = 1;
+	y_pos = H-2;
+}
+
+void Wereld :: grotwand (Richting richting)
+{
+	const int marge       = wereld_hoogte / 3 ;
+	const int max_breedte = wereld_breedte / 10 ;
+
+	for (int ix = 2; ix <= wereld_breedte-3; )
+	{
+		const int breedte = willekeurig () % (min (max_breedte, wereld_breedte - ix - 2)) + 1 ;
+		const int dy = willekeurig () % marge + 2 ;
+		int y ;
+		if (richting == Noord)
+			y = dy ;
+		else
+			y = wereld_hoogte - dy - 1 ;
+		vulRij (y, ix, ix + breedte, Muur) ;
+		ix += breedte ;
+	}
+}
+
+void Wereld :: maakGrot ()
+{
+	maakLeeg () ;
+	rechthoek (0,0, wereld_breedte,wereld_hoogte,Muur);
+	grotwand (Noord) ;
+	grotwand (Zuid) ;
+	x_pos = 1;
+	y_pos = wereld_hoogte-2;
+}
+
+void Wereld :: creeerBal (int x, int y)
+{
+	if (x >= 0 && x < wereld_breedte && y >= 0 && y < wereld_hoogte)
+		zetVeld (x, y, Bal);
+}
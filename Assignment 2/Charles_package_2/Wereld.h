@@ -0,0 +1,187 @@
+#ifndef WERELD_H
+#define WERELD_H
+
+#include "Bitvlak.h"
+
+/*
+	Wereld is the headless world model of Charles: the grid of fields, the position and
+	direction of the robot, the primitives that change them and the world generators.
+	It does not draw anything; ROBOT (in Robot.cpp) renders a Wereld in the RobotGUI window.
+	Because it is independent of the gui_kernel it can be used by benchmarks and batch tools.
+
+	For every field the world knows how many free fields there are in each direction before
+	the next wall (vrij), so that stappen and naarMuur take any number of steps at once. The
+	distances of a row or column are measured again the first time they are needed after a
+	wall in that row or column has been placed or removed; because even a const Wereld may
+	measure, threads must not share a Wereld without a lock.
+
+	The balls and walls are also kept as a Bitvlak, so that reeks can check a whole row or column of
+	fields ahead of Charles for balls at once, and zetBallen can put or take them at once.
+	The generators are built on vulRechthoek and its rows and columns: a column of fields is
+	one fill of the column-major array, the planes are set with a word mask per 64 fields,
+	and the distances are measured again only in the rows and columns where walls changed.
+	They draw their random numbers with willekeurig (Toeval.h): rand (), unless the thread
+	has given them a seeded source of its own.
+
+	hash identifies the fields of the world (not the position of Charles), for instance to
+	see whether a world has changed or to recognise a world that was seen before. It is
+	computed again, once, the first time it is asked for after a change.
+
+	The world also keeps the smallest rectangle around the fields that changed; neemWijziging
+	hands it out and starts a new one, so that a view (Overzicht.h, Dichtheid.h) only has to paint
+	what changed since it looked last. A new world has changed everywhere.
+
+	A Wereld for one run, such as the copy a program runs on, can keep all of its data in an
+	Arena (Arena.h); it must then be gone before the arena is emptied. Copying a Wereld or
+	assigning to it does not move data into or out of an arena.
+*/
+
+enum Veld { Leeg, Bal, Muur };
+
+enum Richting { Noord, West, Zuid, Oost };
+
+const int WereldBreedte = 50;
+const int WereldHoogte	= 30;
+
+enum IllegaleActies { IA_Karel, IA_Stap, IA_PakBal, IA_LegBal, IA_Open, IA_Limiet, IA_Onderbroken, IA_Gesloten} ;
+
+class IllegaleActie
+{
+public:
+	IllegaleActie (IllegaleActies ia) : _actie (ia) {}
+	void report () ;
+	IllegaleActies actie () const { return _actie; }
+private:
+	IllegaleActies _actie;
+} ;
+
+class Wereld
+{
+public:
+	Wereld (int breedte = WereldBreedte, int hoogte = WereldHoogte, Arena *arena = 0);
+	Wereld (const Wereld& ander, Arena *arena);
+
+	int			breedte			() const { return wereld_breedte; }
+	int			hoogte			() const { return wereld_hoogte; }
+	Veld		veld			(int x, int y) const { return Veld (velden [x * wereld_hoogte + y]); }
+	void		zetVeld			(int x, int y, Veld v);
+	int			vrij			(int x, int y, Richting r) const;	//	the number of fields before the next wall
+	unsigned long long	hash	() const;
+	bool		neemWijziging	(int& lx, int& ly, int& rx, int& ry);	//	the fields changed since the last call, half-open; false if none
+
+	int			x				() const { return x_pos; }
+	int			y				() const { return y_pos; }
+	Richting	richting		() const { return huidige_richting; }
+	void		plaatsRobot		(int x, int y, Richting r);
+
+//	The primitives of Charles:
+	void		stap			();
+	void		linksom 		();
+	void		rechtsom 		();
+	void		draai			(int links) { huidige_richting = (Richting) ((huidige_richting + links) & 3); }
+	int			stappen			(int n);		//	at most n steps, up to the wall; returns the number taken
+	int			naarMuur		() { return stappen (vrijVoor ()); }
+	int			vrijVoor		() const { return vrij (x_pos, y_pos, huidige_richting); }
+
+//	Fields ahead of Charles: 'van' fields ahead (0: his own field) and the n - 1 after it.
+//	They must lie inside the world and must not be walls.
+	int			reeks			(int van, int n, bool bal) const;	//	how many in a row from 'van' on have (bal) or have no ball
+	void		zetBallen		(int van, int n, bool bal);
+	const Bitvlak&	ballen		() const { return ballen_vlak; }
+	const Bitvlak&	muren		() const { return muren_vlak; }
+	bool		bovenopBal		() const { return veld (x_pos, y_pos) == Bal; }
+	void		pakBal			();
+	void		legBal			();
+	bool		muurVoor		() const;
+	bool		noord			() const { return huidige_richting == Noord; }
+
+//	Building worlds; the spans and rectangles are half-open and must lie inside the world:
+	void		maakLeeg		();
+	void		vulRechthoek	(int lx, int ly, int rx, int ry, Veld veld);
+	void		vulRij			(int y, int lx, int rx, Veld veld) { vulRechthoek (lx, y, rx, y + 1, veld); }
+	void		vulKolom		(int x, int ly, int ry, Veld veld) { vulRechthoek (x, ly, x + 1, ry, veld); }
+	void		rechthoek		(int lx, int ly, int rx, int ry, Veld veld);	//	the outline only
+	void		laadMuren		(int x, int aantal, const unsigned long long muren []);	//	columns x ..: a wall for every bit, empty fields otherwise
+	void		reset			();
+	void		laad			(const char naam []);
+
+	void		plaatsRechthoek (int links, int onder, int breedte, int hoogte) ;
+	void		maakMuur		(int links, int onder, int aantal, bool horizontaal) ;
+	void		maakBallenSnoer () ;
+	void		maakBallenChaos () ;
+	void		maakBallenPad	() ;
+	void		grotwand		(Richting richting) ;
+	void		maakGrot		() ;
+	void		creeerBal		(int x, int y) ;
+
+private:
+	int							wereld_breedte;
+	int							wereld_hoogte;
+	ArenaVector<unsigned char>	velden;			// column-major, like the original Veld [WereldBreedte][WereldHoogte]
+
+	Bitvlak						ballen_vlak;	// the fields with a ball
+	Bitvlak						muren_vlak;		// the fields with a wall
+
+	mutable ArenaVector<int>	afstanden [4];	// vrij per Richting, in the same order as velden; allocated when first measured
+	mutable ArenaVector<char>	rij_gemeten;	// false if a wall in the row has changed since it was measured
+	mutable ArenaVector<char>	kolom_gemeten;
+	mutable unsigned long long	velden_hash;
+	mutable bool				hash_geldig;	// false if a field has changed since velden_hash was computed
+	int							gewijzigd_lx, gewijzigd_ly;	// the fields changed since the last neemWijziging,
+	int							gewijzigd_rx, gewijzigd_ry;	// half-open; empty if gewijzigd_lx >= gewijzigd_rx
+
+	void		wijzig			(int lx, int ly, int rx, int ry);
+	void		meetRij			(int y) const;
+	void		meetKolom		(int x) const;
+
+	Richting	huidige_richting;
+	int			x_pos;
+	int			y_pos;
+} ;
+
+//	wijzig records that the fields from (lx,ly) up to (rx,ry) have changed.
+inline void Wereld :: wijzig (int lx, int ly, int rx, int ry)
+{
+	hash_geldig = false;
+	if (gewijzigd_lx >= gewijzigd_rx)
+	{
+		gewijzigd_lx = lx; gewijzigd_ly = ly; gewijzigd_rx = rx; gewijzigd_ry = ry;
+	}
+	else
+	{
+		if (lx < gewijzigd_lx) gewijzigd_lx = lx;
+		if (ly < gewijzigd_ly) gewijzigd_ly = ly;
+		if (rx > gewijzigd_rx) gewijzigd_rx = rx;
+		if (ry > gewijzigd_ry) gewijzigd_ry = ry;
+	}
+}
+
+inline void Wereld :: zetVeld (int x, int y, Veld v)
+{
+	unsigned char& veld = velden [x * wereld_hoogte + y];
+	wijzig (x, y, x + 1, y + 1);
+	if ((veld == Muur) != (v == Muur))
+	{
+		rij_gemeten [y] = kolom_gemeten [x] = false;
+		muren_vlak.zet (x, y, v == Muur);
+	}
+	if ((veld == Bal) != (v == Bal))
+		ballen_vlak.zet (x, y, v == Bal);
+	veld = (unsigned char) v;
+}
+
+inline int Wereld :: vrij (int x, int y, Richting r) const
+{
+	if (r == Oost || r == West)
+	{
+		if (!rij_gemeten [y])
+			meetRij (y);
+	}
+	else if (!kolom_gemeten [x])
+		meetKolom (x);
+	return afstanden [r][x * wereld_hoogte + y];
+}
+
+extern int kies3 ();
+
+#endif
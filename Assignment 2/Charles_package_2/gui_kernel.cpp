@@ -16,12 +16,20 @@
 *****************************************************************************************/
 
 #include "gui_kernel.h"
+#include "Tellers.h"
+#include "Spoor.h"
 
 #include <algorithm>
+#include <cctype>
 #include <cstdlib>
+#include <malloc.h>
+#include <mmsystem.h>
 
 using namespace std;
 
+static LONGLONG timerClock ();		//	see Timing operations
+static LONGLONG timerFrequency ();
+
 
 bool isbetween (int x, int low, int up)
 {
@@ -142,23 +150,12 @@ const RGBCOLOUR RedRGB		= RGBCOLOUR (RGBCOLOUR :: MAXRGB, RGBCOLOUR :: MINRGB, R
 const RGBCOLOUR GreenRGB	= RGBCOLOUR (RGBCOLOUR :: MINRGB, RGBCOLOUR :: MAXRGB, RGBCOLOUR :: MINRGB);
 const RGBCOLOUR BlueRGB		= RGBCOLOUR (RGBCOLOUR :: MINRGB, RGBCOLOUR :: MINRGB, RGBCOLOUR :: MAXRGB);
 
-static GPOINT canvas_penpos = GPOINT (0,0);	// The pen-position
-
 
 /*****************************************************************************************
 	Menu stuff:
 *****************************************************************************************/
-struct MenuItem
-{
-	MenuCallBack	mi_action;		//	the callback procedure
-	MenuItems 	 	mi_next;		//	the next callback procedure
-	char			*mi_title;
-
-					MenuItem (char *title, MenuCallBack action);
-} ;
-
 HMENU	menuBar;					//	the handle to the top-level menu in which pull-down menus are created
-Menus	Menu :: menu_bar	= NULL;
+vector<Menus>	Menu :: menu_bar;
 
 
 /*****************************************************************************************
@@ -171,27 +168,63 @@ BOOL    CALLBACK DialogProc        (HWND, UINT, WPARAM, LPARAM);	// The callback
 
 
 /*****************************************************************************************
-	Canvas stuff:
+	GDI objects:
 *****************************************************************************************/
 
-bool Canvas :: canvas_created = false;
+atomic<int> GdiObject :: gdi_live (0);
+
+GdiObject :: GdiObject (HGDIOBJ object)
+	: gdi_object (object)
+{
+	if (gdi_object != NULL)
+		gdi_live.fetch_add (1, memory_order_relaxed);
+}
+
+GdiObject :: GdiObject (GdiObject&& other)
+	: gdi_object (other.gdi_object)
+{
+	other.gdi_object = NULL;
+}
+
+GdiObject :: ~GdiObject ()
+{
+	if (gdi_object != NULL)
+	{
+		DeleteObject (gdi_object);
+		gdi_live.fetch_sub (1, memory_order_relaxed);
+	}
+}
+
+GdiObject& GdiObject :: operator= (GdiObject&& other)
+{
+	if (this != &other)
+	{
+		GdiObject old (std::move (*this));		// deletes the object this owned
+		gdi_object = other.gdi_object;
+		other.gdi_object = NULL;
+	}
+	return *this;
+}
+
+
+/*****************************************************************************************
+	Canvas stuff:
+*****************************************************************************************/
 
 Canvas :: Canvas (GUI &gui)
-	: canvas_gui (gui)
+	: target (gui.gui_target), drawingContext (gui.gui_target.target_dc)
+{
+	tellerPlus (T_Canvas);
+}
+
+Canvas :: Canvas (RenderTarget &target)
+	: target (target), drawingContext (target.target_dc)
 {
-	if (canvas_created)
-		throw GUITerminated (GUITerminated :: GFK_MultipleCanvas);
-	canvas_created = true;
-	drawingContext = GetDC (gui.the_window);
-//	drawingContext = GetDC (gui.the_window);
-	setPenPos (canvas_penpos);		// penpos must be set
+	tellerPlus (T_Canvas);
 }
 
 Canvas :: ~Canvas (void)
 {
-//	ReleaseDC (canvas_gui.the_window,drawingContext);
-	ReleaseDC (canvas_gui.the_window,drawingContext);
-	canvas_created = false;
 }
 
 
@@ -202,7 +235,9 @@ Canvas :: ~Canvas (void)
 bool GUI :: gui_created = false;
 
 GUI :: GUI (GSIZE windowSize, char *title)
-	: canvas_origin (GPOINT(0,0)), pen_colour (BlackRGB), in_normal_mode (true), windowSize (windowSize), windowTitle (title), gui_nr_of_menus (0), gui_timer (), mouse_is_down (false), quitRequested (false)
+	: windowSize (windowSize), windowTitle (title), gui_busy (0), gui_accelerators (NULL), gui_timer (-1), gui_timer_period (0),
+	  gui_wait_timer (NULL), gui_system_period (false), gui_heap_blocks (0), gui_heap_bytes (0), gui_heap_walked (0),
+	  mouse_is_down (false), quitRequested (false)
 {
 	if (gui_created)
 		throw GUITerminated (GUITerminated :: GFK_MultipleGUIs);
@@ -276,21 +311,8 @@ void GUI :: InitialiseDrawingLibrary (WINARGS winArgs)
 					);
 	SetGWL_USERDATA ((LONG)this, the_window);	// store reference to GUI object in the window
 
-	//	Initialise the drawing context of the window:
-	blackPen   = GetStockObject (BLACK_PEN);	// Initialise the pens
-	whitePen   = GetStockObject (WHITE_PEN);
-	nullPen    = GetStockObject (NULL_PEN);
-	blackBrush = GetStockObject (BLACK_BRUSH);	// Initialise the brushes
-	whiteBrush = GetStockObject (WHITE_BRUSH);
-	nullBrush  = GetStockObject (NULL_BRUSH);
-	penColour  = RGB (0,0,0);					// Set colour to black
-
-	HDC dc = GetDC (the_window);		// Initialise the drawing context of the window to filling
-	SelectObject (dc, blackPen);
-	SelectObject (dc, blackBrush);
-	SetTextAlign (dc, TA_UPDATECP);	// Drawing text with TextOut now uses current pen position and updates it
-	SetBkMode (dc, TRANSPARENT);	// Drawing text will not erase background
-	ReleaseDC (the_window,dc);
+	//	Initialise the drawing context of the window; it is kept until WM_DESTROY
+	gui_target.attach (GetDC (the_window));
 
 	//	Set the range of both scrollbars
 	SetScrollRange (the_window,SB_HORZ,MINCOORD,MAXCOORD-windowSize.cx,true);
@@ -299,6 +321,18 @@ void GUI :: InitialiseDrawingLibrary (WINARGS winArgs)
 	ShowWindow (the_window, winArgs.iCmdShow);
 
 	the_dialogs = NULL;
+
+	//	The waitable timer of the event loop: a high resolution one where Windows has them
+	typedef HANDLE (WINAPI *CreateTimerEx) (LPSECURITY_ATTRIBUTES, LPCWSTR, DWORD, DWORD);
+	const DWORD HighResolutionTimer = 0x00000002;		//	CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+	const CreateTimerEx createTimerEx = (CreateTimerEx) GetProcAddress (GetModuleHandle ("kernel32.dll"), "CreateWaitableTimerExW");
+	if (createTimerEx != NULL)
+		gui_wait_timer = createTimerEx (NULL, NULL, HighResolutionTimer, TIMER_ALL_ACCESS);
+	if (gui_wait_timer == NULL)
+	{
+		gui_system_period = timeBeginPeriod (1) == TIMERR_NOERROR;
+		gui_wait_timer    = CreateWaitableTimer (NULL, FALSE, NULL);
+	}
 }
 
 
@@ -569,9 +603,9 @@ DialogItemType GetDialogItemAndType (DialogPtr the_dialog, ControlId item, HWND&
 //	CountDITL counts the number of dialog items in the dialog.
 int CountDITL (DialogPtr the_dialog)
 {
-	GetDialogItemInfo *info = new GetDialogItemInfo ();
-	if (EnumChildWindows (the_dialog, (WNDENUMPROC) EnumGetDialogItem, (LPARAM) info))
-		return info->gdi_nr_of_items;
+	GetDialogItemInfo info;
+	if (EnumChildWindows (the_dialog, (WNDENUMPROC) EnumGetDialogItem, (LPARAM) &info))
+		return info.gdi_nr_of_items;
 	else
 		return 0;
 }	/* CountDITL */
@@ -598,9 +632,9 @@ BOOL CALLBACK EnumCreateControlRef (HWND hwndControl, LPARAM lParam)
 //	CreateControlRefs creates the ControlRepr list of a dialog.
 void CreateControlRefs (DialogPtr the_dialog, ControlRepr **last_control_ptr)
 {
-	CreateControlRefInfo *info = new CreateControlRefInfo (last_control_ptr);
+	CreateControlRefInfo info (last_control_ptr);
 
-	EnumChildWindows (the_dialog, (WNDENUMPROC) EnumCreateControlRef, (LPARAM) info);
+	EnumChildWindows (the_dialog, (WNDENUMPROC) EnumCreateControlRef, (LPARAM) &info);
 }	/* CreateControlRefs */
 
 ControlRef DialogRepr :: getControlRef (ControlId control_id, DialogItemType item_type)
@@ -830,17 +864,50 @@ DialogHandle searchForDialog (DialogPtr dialog, DialogHandle dialogs)
 /*	RunGUI implements the event loop of the interactive process.
 */
 void GUI :: RunGUI (void)
+{
+	while (!quitRequested)
+	{
+		evaluateTimers ();
+		waitForInput (nextTimerDue ());
+		dispatchMessages ();
+	}
+};
+
+//	dispatchMessages handles the messages that are waiting, without waiting for more.
+void GUI :: dispatchMessages (void)
 {
 	MSG msg;
-	while (!quitRequested && GetMessage (&msg, NULL, 0, 0))
+	while (PeekMessage (&msg, NULL, 0, 0, PM_REMOVE))
 	{
+		if (msg.message == WM_QUIT)
+		{
+			quitRequested = true;
+			return;
+		}
+
+		SpoorStuk spoor ("dispatch");
+		if (gui_accelerators != NULL && TranslateAccelerator (the_window, gui_accelerators, &msg))
+			continue;
 		if (activeDialog == NULL || !IsDialogMessage (activeDialog, &msg))
 		{
 			TranslateMessage (&msg);
 			DispatchMessage  (&msg);
 		}
 	}
-};
+}
+
+bool GUI :: ProcessMessages (double wait)
+{
+	if (wait > 0)
+	{
+		const LONGLONG until = timerClock () + (LONGLONG) (wait * timerFrequency () / 1000.0);
+		const LONGLONG due   = nextTimerDue ();
+		waitForInput (due >= 0 ? min (until, due) : until);
+	}
+	dispatchMessages ();
+	evaluateTimers ();
+	return IsWindow (the_window) != FALSE;
+}
 
 //	Run without menus
 void GUI :: Run (WINARGS winArgs)
@@ -849,63 +916,64 @@ void GUI :: Run (WINARGS winArgs)
 	RunGUI ();
 }
 
+//	Open the window without running the event loop
+void GUI :: Open (WINARGS winArgs)
+{
+	InitialiseDrawingLibrary (winArgs);
+}
+
 //	Run with menus
+//	The command id of a menu item is its index in gui_commands, so WM_COMMAND needs no search.
+//	Command id 0 is not used, because Windows reserves it.
 void GUI :: Run (Menu &menu, WINARGS winArgs)
 {
 	InitialiseDrawingLibrary (winArgs);
 
-	gui_nr_of_menus = 0;
-	int gui_nr_of_items = 0;
+	const Command none = { NULL, false };
+	gui_commands.assign (1, none);
+	vector<ACCEL> shortcuts;
 
-	Menus next_menu;
-	// First count the number of menu items so that we can distribute correct numbers.
-	for (next_menu = menu.menu_bar; next_menu != NULL; next_menu = next_menu -> menu_next)
-	{
-		for (MenuItems next_item = next_menu -> menu_call_backs; next_item != NULL; next_item = next_item -> mi_next)
-		{
-			gui_nr_of_items++;
-		}
-	}
-	// Now create menu(items) with correct numbers [gui_nr_of_items..1]:
-	for (next_menu = menu.menu_bar; next_menu != NULL; next_menu = next_menu -> menu_next)
+	for (size_t m = 0; m < menu.menu_bar.size (); m++)
 	{
+		const Menus next_menu = menu.menu_bar [m];
 		HMENU menu_handle = CreatePopupMenu ();
 
-		// Count nr of items
-		int nrItems = 0;
-		MenuItems next_item;
-		for (next_item = next_menu -> menu_call_backs; next_item != NULL; next_item = next_item -> mi_next)
+		for (size_t i = 0; i < next_menu -> menu_items.size (); i++)
 		{
-			nrItems++;
-		}
-		gui_nr_of_items -= nrItems;
-		int itemnr = gui_nr_of_items;
+			const MenuItem& item = next_menu -> menu_items [i];
+			const UINT itemnr = (UINT) gui_commands.size ();
 
-		for (next_item = next_menu -> menu_call_backs; next_item != NULL; next_item = next_item -> mi_next)
-		{
-			if (strcmp (next_item -> mi_title,"-(") == 0)
-				InsertMenu (menu_handle,0xFFFFFFFF,MF_BYPOSITION | MF_SEPARATOR,(UINT)itemnr,0);
+			const Command command = { item.mi_action, next_menu -> menu_live };
+			gui_commands.push_back (command);
+			if (item.mi_action == NULL)
+				InsertMenu (menu_handle,0xFFFFFFFF,MF_BYPOSITION | MF_SEPARATOR,itemnr,0);
 			else
-				InsertMenu (menu_handle,0xFFFFFFFF,MF_BYPOSITION | MF_STRING,   (UINT)itemnr,next_item -> mi_title);
-			itemnr++;
+				InsertMenu (menu_handle,0xFFFFFFFF,MF_BYPOSITION | MF_STRING,   itemnr,item.mi_title.c_str ());
+
+			if (item.mi_key != 0)
+			{
+				ACCEL shortcut;
+				shortcut.fVirt = (BYTE) (FVIRTKEY | item.mi_modifiers);
+				shortcut.key   = (WORD) item.mi_key;
+				shortcut.cmd   = (WORD) itemnr;
+				shortcuts.push_back (shortcut);
+			}
 		}
 
-		InsertMenu (menuBar, 0, MF_BYPOSITION | MF_POPUP, (UINT)menu_handle,next_menu->menu_title);
-		gui_nr_of_menus++;
+		InsertMenu (menuBar, 0xFFFFFFFF, MF_BYPOSITION | MF_POPUP, (UINT)menu_handle,next_menu->menu_title);
 	}
 
-	gui_menus = new MenuItems [gui_nr_of_menus];
+	if (!shortcuts.empty ())
+		gui_accelerators = CreateAcceleratorTable (&shortcuts [0], (int) shortcuts.size ());
 
-	int this_menu = gui_nr_of_menus - 1;
+	DrawMenuBar (the_window);
+	RunGUI ();
 
-	for (next_menu = menu.menu_bar; next_menu != NULL; next_menu = next_menu -> menu_next)
+	if (gui_accelerators != NULL)
 	{
-		gui_menus [this_menu] = next_menu -> menu_call_backs;
-		this_menu--;
+		DestroyAcceleratorTable (gui_accelerators);
+		gui_accelerators = NULL;
 	}
-
-	DrawMenuBar (the_window);
-	RunGUI ();
 }
 
 
@@ -913,38 +981,154 @@ void GUI :: Run (Menu &menu, WINARGS winArgs)
 	Timing operations:
 *****************************************************************************************/
 
-VOID CALLBACK GUI :: EvaluateTimer (HWND hwnd, UINT uMsg, UINT idEvent, DWORD dwTime)
+//	The performance counter, in ticks, and the number of ticks per second.
+static LONGLONG timerClock ()
 {
-	GUI *gui = (GUI*)GetGWL_USERDATA (hwnd);	// Retrieve reference to GUI object
+	LARGE_INTEGER now;
+	QueryPerformanceCounter (&now);
+	return now.QuadPart;
+}
 
-	gui->Timer (gui->gui_timer.timer_period);	// Simply call the timer callback,
-	if (gui->gui_timer.timerID != 0)			// and restart the timer if not stopped by callback
+static LONGLONG timerFrequency ()
+{
+	static LONGLONG frequency = 0;
+	if (frequency == 0)
 	{
-		KillTimer (NULL, gui->gui_timer.timerID);
-		gui->gui_timer.timerID = SetTimer (hwnd, (UINT)1, gui->gui_timer.timer_period, EvaluateTimer);
+		LARGE_INTEGER f;
+		QueryPerformanceFrequency (&f);
+		frequency = f.QuadPart;
 	}
+	return frequency;
+}
+
+//	EvaluateTimer is the callback of the timer of startTimer.
+void GUI :: EvaluateTimer (TimerId id, void *gui)
+{
+	GUI *the_gui = (GUI*) gui;
+	the_gui->Timer (the_gui->gui_timer_period);
 }
 
 void GUI :: startTimer (int dt)
 {
-	gui_timer.timer_period		= (dt < 0)  ? 0 : (UINT)dt;
+	gui_timer_period = (dt < 0) ? 0 : dt;
 
-	if (gui_timer.timerID != 0)			// Timer is already open, close it first
+	if (gui_timer >= 0)					// Timer is already open, close it first
+		removeTimer (gui_timer);
+	//	SetTimer, which was used before, never fired more often than every 10 milliseconds
+	gui_timer = addTimer (Maximum (gui_timer_period, 10), EvaluateTimer, this);
+}
+
+void GUI :: stopTimer ()
+{
+	if (gui_timer >= 0)
 	{
-		KillTimer (NULL, gui_timer.timerID);
+		removeTimer (gui_timer);
+		gui_timer = -1;
 	}
-	gui_timer.timerID = SetTimer (the_window, (UINT)1, gui_timer.timer_period, EvaluateTimer);
 }
 
-void GUI :: stopTimer ()
+TimerId GUI :: addTimer (double dt, TimerCallBack callback, void *argument)
+{
+	TimerId id = 0;
+	while (id < (TimerId) gui_timers.size () && gui_timers [id].callback != NULL)
+		id++;
+	if (id == (TimerId) gui_timers.size ())
+	{
+		TimerDef unused;
+		unused.callback   = NULL;
+		unused.generation = 0;
+		gui_timers.push_back (unused);
+	}
+
+	TimerDef& timer = gui_timers [id];
+	timer.period   = (dt <= 0) ? 0 : (LONGLONG) (dt * timerFrequency () / 1000.0);
+	timer.next     = timerClock () + timer.period;
+	timer.callback = callback;
+	timer.argument = argument;
+
+	TimerDue due = { timer.next, id, timer.generation };
+	gui_due.push (due);
+	return id;
+}
+
+void GUI :: removeTimer (TimerId id)
 {
-	if (gui_timer.timerID != 0)
+	if (id >= 0 && id < (TimerId) gui_timers.size () && gui_timers [id].callback != NULL)
 	{
-		KillTimer (the_window,gui_timer.timerID);
-		gui_timer.timerID = 0;
+		gui_timers [id].callback = NULL;
+		gui_timers [id].generation++;	// its entry in gui_due is dropped when it comes on top
 	}
 }
 
+/*	evaluateTimers calls every timer that is due, once, and schedules its next moment.
+	A timer is rescheduled before its callback is called, so that the callback can remove it.
+*/
+void GUI :: evaluateTimers ()
+{
+	const LONGLONG now = timerClock ();
+	while (!gui_due.empty () && gui_due.top ().next <= now)
+	{
+		TimerDue due = gui_due.top ();
+		gui_due.pop ();
+
+		TimerDef& timer = gui_timers [due.id];
+		if (timer.callback == NULL || timer.generation != due.generation)
+			continue;
+
+		timer.next += timer.period;
+		const LONGLONG later = timerClock ();
+		if (timer.next <= later)		// missed ticks are skipped
+			timer.next = later + (timer.period > 0 ? timer.period : 1);
+		due.next = timer.next;
+		gui_due.push (due);
+
+		TimerCallBack callback = timer.callback;
+		callback (due.id, timer.argument);
+	}
+}
+
+//	nextTimerDue is the moment the first timer is due, on timerClock; -1 if there is no timer.
+LONGLONG GUI :: nextTimerDue ()
+{
+	while (!gui_due.empty ())
+	{
+		const TimerDue& due = gui_due.top ();
+		const TimerDef& timer = gui_timers [due.id];
+		if (timer.callback != NULL && timer.generation == due.generation)
+			break;
+		gui_due.pop ();
+	}
+	return gui_due.empty () ? -1 : gui_due.top ().next;
+}
+
+/*	waitForInput waits until there is input, or until the moment until on timerClock (-1: no
+	such moment). The waitable timer is set to until, so the wait does not end early and
+	busy-wait; without the timer the time-out is rounded up to whole milliseconds.
+*/
+void GUI :: waitForInput (LONGLONG until)
+{
+	if (until < 0)
+	{
+		MsgWaitForMultipleObjectsEx (0, NULL, INFINITE, QS_ALLINPUT, MWMO_INPUTAVAILABLE);
+		return;
+	}
+	const LONGLONG left = until - timerClock ();
+	if (left <= 0)
+		return;
+	if (gui_wait_timer != NULL)
+	{
+		LARGE_INTEGER due;
+		due.QuadPart = - (left * 10000000 / timerFrequency () + 1);		//	relative, in units of 100 ns
+		if (SetWaitableTimer (gui_wait_timer, &due, 0, NULL, NULL, FALSE))
+		{
+			MsgWaitForMultipleObjectsEx (1, &gui_wait_timer, INFINITE, QS_ALLINPUT, MWMO_INPUTAVAILABLE);
+			return;
+		}
+	}
+	const DWORD timeout = (DWORD) ((left * 1000 + timerFrequency () - 1) / timerFrequency ());
+	MsgWaitForMultipleObjectsEx (0, NULL, timeout, QS_ALLINPUT, MWMO_INPUTAVAILABLE);
+}
+
 
 /*****************************************************************************************
 	General operations:
@@ -972,6 +1156,183 @@ void GUI :: Stop ()
 }
 
 
+/*****************************************************************************************
+	Render targets:
+*****************************************************************************************/
+
+RenderTarget :: RenderTarget ()
+	: target_dc (NULL), origin (GPOINT (0,0)), pen_colour (BlackRGB), penColour (RGB (0,0,0)), in_normal_mode (true),
+	  black_pen (GetStockObject (BLACK_PEN)), black_brush (GetStockObject (BLACK_BRUSH)), null_brush (GetStockObject (NULL_BRUSH)),
+	  dc_brush (NULL), colour_brush (NULL), pen_pos (GPOINT (0,0)), dc_pos_known (false)
+{
+}
+
+RenderTarget :: ~RenderTarget ()
+{
+}
+
+//	attach initialises dc to filling with the colour of the pen, which is black.
+void RenderTarget :: attach (HDC dc)
+{
+	target_dc = dc;
+	SelectObject (target_dc, black_pen);
+	SelectObject (target_dc, black_brush);
+	dc_brush     = black_brush;
+	colour_brush = black_brush;
+	pen_colour   = BlackRGB;
+	penColour    = RGB (0,0,0);
+	dc_pos_known = false;
+	SetTextAlign (target_dc, TA_UPDATECP);	// Drawing text with TextOut now uses current pen position and updates it
+	SetBkMode (target_dc, TRANSPARENT);		// Drawing text will not erase background
+}
+
+void RenderTarget :: detach ()
+{
+	releaseColourObjects ();
+	SelectObject (target_dc, GetStockObject (SYSTEM_FONT));
+	target_dc = NULL;
+}
+
+//	colourObjects returns the pen and brush of colour, and creates them when the colour is
+//	used for the first time. When the cache is full it is emptied first.
+const RenderTarget::ColourObjects& RenderTarget :: colourObjects (COLORREF colour)
+{
+	map<COLORREF, ColourObjects>::const_iterator found = colour_objects.find (colour);
+	if (found != colour_objects.end ())
+		return found -> second;
+
+	if (colour_objects.size () >= MaxColourObjects)
+		releaseColourObjects ();
+
+	LOGBRUSH logicalBrush;
+	logicalBrush.lbStyle = BS_SOLID;
+	logicalBrush.lbColor = colour;
+	logicalBrush.lbHatch = 0;
+	ColourObjects& objects = colour_objects [colour];
+	objects.pen   = GdiObject (ExtCreatePen (PS_COSMETIC | PS_SOLID, 1, &logicalBrush, 0, NULL));
+	objects.brush = GdiObject (CreateSolidBrush (colour));
+	tellerPlus (T_GdiAanroep, 2);
+	return objects;
+}
+
+//	releaseColourObjects deletes all kept pens and brushes; the drawing context gets the stock black pen and brush.
+void RenderTarget :: releaseColourObjects ()
+{
+	SelectObject (target_dc, black_pen);
+	SelectObject (target_dc, black_brush);
+	dc_brush     = black_brush;
+	colour_brush = black_brush;
+	colour_objects.clear ();
+}
+
+void RenderTarget :: selectBrush (HGDIOBJ brush)
+{
+	if (brush != dc_brush)
+	{
+		tellerPlus (T_GdiAanroep);
+		SelectObject (target_dc, brush);
+		dc_brush = brush;
+	}
+}
+
+//	moveTo sets the current position of the drawing context, in the coordinates of the context.
+void RenderTarget :: moveTo (int x, int y)
+{
+	if (!dc_pos_known || dc_pos.x != x || dc_pos.y != y)
+	{
+		tellerPlus (T_GdiAanroep);
+		MoveToEx (target_dc, x, y, NULL);
+		dc_pos.x     = x;
+		dc_pos.y     = y;
+		dc_pos_known = true;
+	}
+}
+
+BitmapTarget :: BitmapTarget (GSIZE size)
+	: bitmap_size (size), old_bitmap (NULL), bitmap_bits (NULL)
+{
+	if (!size.valid ())
+		throw GUITerminated (GUITerminated :: GFK_NoBitmap);
+
+	BITMAPINFO info;
+	memset (&info, 0, sizeof (info));
+	info.bmiHeader.biSize			= sizeof (info.bmiHeader);
+	info.bmiHeader.biWidth			= size.cx;
+	info.bmiHeader.biHeight			= -size.cy;			// negative: the rows from top to bottom
+	info.bmiHeader.biPlanes			= 1;
+	info.bmiHeader.biBitCount		= 32;
+	info.bmiHeader.biCompression	= BI_RGB;
+
+	void *bits = NULL;
+	bitmap = GdiObject (CreateDIBSection (NULL, &info, DIB_RGB_COLORS, &bits, NULL, 0));
+	const HDC dc = CreateCompatibleDC (NULL);
+	if (bitmap.get () == NULL || dc == NULL)
+	{
+		if (dc != NULL)
+			DeleteDC (dc);
+		throw GUITerminated (GUITerminated :: GFK_NoBitmap);
+	}
+	bitmap_bits = (DWORD*) bits;
+	old_bitmap  = SelectObject (dc, bitmap.get ());
+	attach (dc);
+	clear (WhiteRGB);
+}
+
+BitmapTarget :: ~BitmapTarget ()
+{
+	const HDC dc = target_dc;
+	detach ();
+	SelectObject (dc, old_bitmap);		// before bitmap deletes the image
+	DeleteDC (dc);
+}
+
+DWORD* BitmapTarget :: pixels ()
+{
+	GdiFlush ();
+	return bitmap_bits;
+}
+
+void BitmapTarget :: clear (RGBCOLOUR colour)
+{
+	const DWORD pixel = (colour.r << 16) | (colour.g << 8) | colour.b;
+	DWORD *bits = pixels ();
+	fill (bits, bits + bitmap_size.cx * bitmap_size.cy, pixel);
+}
+
+
+/*****************************************************************************************
+	Resource usage:
+*****************************************************************************************/
+
+ResourceUsage GUI :: GetResourceUsage ()
+{
+	ResourceUsage usage;
+	usage.gdi_objects		= GetGuiResources (GetCurrentProcess (), GR_GDIOBJECTS);
+	usage.user_objects		= GetGuiResources (GetCurrentProcess (), GR_USEROBJECTS);
+	usage.kernel_objects	= GdiObject :: live ();
+	usage.colours			= (int) gui_target.colour_objects.size ();
+
+	const DWORD now = GetTickCount ();
+	if (gui_heap_walked == 0 || now - gui_heap_walked >= HeapSampleInterval)
+	{
+		gui_heap_blocks = 0;
+		gui_heap_bytes  = 0;
+		_HEAPINFO block;
+		block._pentry = NULL;
+		while (_heapwalk (&block) == _HEAPOK)
+			if (block._useflag == _USEDENTRY)
+			{
+				gui_heap_blocks++;
+				gui_heap_bytes += block._size;
+			}
+		gui_heap_walked = now;
+	}
+	usage.heap_blocks		= gui_heap_blocks;
+	usage.heap_bytes		= gui_heap_bytes;
+	return usage;
+}
+
+
 /*****************************************************************************************
 	The window operations:
 *****************************************************************************************/
@@ -990,42 +1351,63 @@ GSIZE GUI :: getWindowSize ()
 	The menu operations:
 *****************************************************************************************/
 
-MenuItem :: MenuItem (char *title, MenuCallBack action)
-	: mi_action (action), mi_next (NULL)
+//	shortcutName returns the text that Windows menus show for a shortcut, such as "Ctrl+R".
+static string shortcutName (char key, int modifiers)
+{
+	string name;
+	if (modifiers & ControlKey)
+		name += "Ctrl+";
+	if (modifiers & AltKey)
+		name += "Alt+";
+	if (modifiers & ShiftKey)
+		name += "Shift+";
+	return name + key;
+}
+
+MenuItem :: MenuItem (const char *title, MenuCallBack action, char key, int modifiers)
+	: mi_title (title), mi_action (action), mi_key (key), mi_modifiers (modifiers)
 {
-	mi_title = title;
+	if (key != 0)
+		mi_title += "\t" + shortcutName (key, modifiers);
 }
 
 Menu :: Menu (char *title)
-	: menu_call_backs (NULL)
+	: menu_live (false)
 {
 	menu_title		= title;
-	menu_next 		= menu_bar;
-	menu_bar		= this;
+	menu_bar.push_back (this);
 
 }
 
-MenuItems& lastItem (MenuItems& first)
+Menu :: ~Menu ()
 {
-	MenuItems *last_item;
+	menu_bar.erase (remove (menu_bar.begin (), menu_bar.end (), this), menu_bar.end ());
+}
 
-	for (last_item = & first; *last_item != NULL;
-		 last_item = & (*last_item) -> mi_next)
-		 ;
-	return *last_item;
+Menu& Menu :: add (char *item_title, MenuCallBack action)
+{
+	menu_items.push_back (MenuItem (item_title, action));
+	return *this;
 
 }
 
-Menu& Menu :: add (char *item_title, MenuCallBack action)
+Menu& Menu :: add (char *item_title, MenuCallBack action, char key, int modifiers)
 {
-	lastItem (menu_call_backs) =  new MenuItem (item_title, action);
+	menu_items.push_back (MenuItem (item_title, action, (char) toupper (key), modifiers));
 	return *this;
 
 }
 
 Menu& Menu :: add ()
 {
-	lastItem (menu_call_backs) =  new MenuItem ((char*)"-(", NULL);
+	menu_items.push_back (MenuItem ("", NULL));
+	return *this;
+
+}
+
+Menu& Menu :: setLive ()
+{
+	menu_live = true;
 	return *this;
 
 }
@@ -1037,74 +1419,71 @@ Menu& Menu :: add ()
 
 void Canvas :: toggleXORmode (void)
 {
-	if (canvas_gui.in_normal_mode)
+	if (target.in_normal_mode)
 	{
 		SetROP2 (drawingContext, R2_NOT);
 //		SetROP2 (canvas_gui.drawingContext, R2_NOT);
-		canvas_gui.in_normal_mode = false;
+		target.in_normal_mode = false;
 	}
 	else
 	{
 		SetROP2 (drawingContext, R2_COPYPEN);
-		canvas_gui.in_normal_mode = true;
+		target.in_normal_mode = true;
 	}
 }	/* toggleXORMode */
 
 void Canvas :: setPenColour (RGBCOLOUR newColour)
 {
-	if (newColour.valid () && ! (canvas_gui.pen_colour == newColour))
+	if (newColour.valid () && ! (target.pen_colour == newColour))
 	{
-		LOGBRUSH logicalBrush;
-
-		canvas_gui.pen_colour = newColour;
+		target.pen_colour = newColour;
+		tellerPlus (T_KleurWissel);
+		tellerPlus (T_GdiAanroep, 2);
 
-		canvas_gui.penColour = RGB (newColour.r,newColour.g,newColour.b);
+		target.penColour = RGB (newColour.r,newColour.g,newColour.b);
 		//	Text will be drawn with the new colour
-		SetTextColor (drawingContext, canvas_gui.penColour);
-		//	Line images will be outlined with the new colour
-		logicalBrush.lbStyle = BS_SOLID;
-		logicalBrush.lbColor = canvas_gui.penColour;
-		logicalBrush.lbHatch = 0;
-//		canvas_gui.thePen  = ExtCreatePen (PS_GEOMETRIC | PS_INSIDEFRAME, 1, &logicalBrush, 0, NULL);
-//		canvas_gui.thePen  = ExtCreatePen (PS_GEOMETRIC | PS_SOLID, 1, &logicalBrush, 0, NULL);
-		canvas_gui.thePen  = ExtCreatePen (PS_COSMETIC | PS_SOLID, 1, &logicalBrush, 0, NULL);
-		DeleteObject (SelectObject (drawingContext,canvas_gui.thePen));
-		canvas_gui.theBrush = CreateSolidBrush (canvas_gui.penColour);
-		//	Line images will be filled with the new colour
-		DeleteObject (SelectObject (drawingContext,canvas_gui.theBrush));
+		SetTextColor (drawingContext, target.penColour);
+		//	Line images will be outlined with the new colour, and filled with it when they are filled
+		const RenderTarget::ColourObjects& objects = target.colourObjects (target.penColour);
+		SelectObject (drawingContext, objects.pen.get ());
+		target.colour_brush = objects.brush.get ();
 	}
 }	/* setPenColour */
 
 RGBCOLOUR Canvas :: getPenColour ()
 {
-	return canvas_gui.pen_colour;
+	return target.pen_colour;
 }	/* getPenColour */
 
 void Canvas :: setPenPos (GPOINT newPos)
 {
 	if (newPos.valid ())
 	{
-		canvas_penpos = newPos;
+		target.pen_pos = newPos;
 		GPOINT origin = getOrigin ();
-		MoveToEx (drawingContext,newPos.x - origin.x, newPos.y - origin.y, NULL);
+		target.moveTo (newPos.x - origin.x, newPos.y - origin.y);
 	}
 }	/* setPenPos */
 
 GPOINT Canvas :: getPenPos ()
 {
-	return canvas_penpos;
+	return target.pen_pos;
 }	/* getPenPos */
 
 void Canvas :: drawPOINT ()
 {
-	GPOINT newpoint (canvas_penpos.x + 1, canvas_penpos.y);
+	const GPOINT penpos = target.pen_pos;
+	GPOINT newpoint (penpos.x + 1, penpos.y);
 	GPOINT origin = getOrigin ();
 
-	SetPixelV (drawingContext, canvas_penpos.x-origin.x, canvas_penpos.y-origin.y, canvas_gui.penColour);
+	tellerPlus (T_Tekenen);
+	tellerPlus (T_GdiAanroep);
+
+	SetPixelV (drawingContext, penpos.x-origin.x, penpos.y-origin.y, target.penColour);
 	if (newpoint.valid ())
-		MoveToEx (drawingContext, newpoint.x-origin.x, newpoint.y-origin.y, NULL);
+		target.moveTo (newpoint.x-origin.x, newpoint.y-origin.y);
 	else
-		MoveToEx (drawingContext, canvas_penpos.x-origin.x, canvas_penpos.y-origin.y, NULL);
+		target.moveTo (penpos.x-origin.x, penpos.y-origin.y);
 }	/* drawPOINT */
 
 void Canvas :: drawLineTo (GPOINT end)
@@ -1114,11 +1493,18 @@ void Canvas :: drawLineTo (GPOINT end)
 		BOOL ok;
 		GPOINT origin = getOrigin ();
 
-		setPenPos (canvas_penpos);
+		tellerPlus (T_Tekenen);
+		tellerPlus (T_GdiAanroep, 2);
+
+		setPenPos (target.pen_pos);
 		ok = LineTo (drawingContext, end.x-origin.x, end.y-origin.y);
-		SetPixelV (drawingContext, end.x-origin.x, end.y-origin.y, canvas_gui.penColour);
-		if (!ok)
-			MoveToEx (drawingContext, end.x-origin.x, end.y-origin.y, NULL);
+		SetPixelV (drawingContext, end.x-origin.x, end.y-origin.y, target.penColour);
+		if (ok)
+		{	//	LineTo has moved the current position to the end of the line
+			target.dc_pos.x     = end.x-origin.x;
+			target.dc_pos.y     = end.y-origin.y;
+			target.dc_pos_known = true;
+		}
 		setPenPos (end);
 	}
 } /* drawLineTo */
@@ -1127,15 +1513,15 @@ void Canvas :: drawRectangle (GPOINT corner1,  GPOINT corner2)
 {
 	if (corner1.valid () && corner2.valid ())
 	{
-		HGDIOBJ prevBrush;
 		RECT rect;
 		GPOINT origin = getOrigin ();
 
 		pointsToRect (origin, corner1, corner2, &rect);
+		tellerPlus (T_Tekenen);
+		tellerPlus (T_GdiAanroep);
 
-		prevBrush = SelectObject (drawingContext, canvas_gui.nullBrush);
+		target.selectBrush (target.null_brush);
 		Rectangle (drawingContext, rect.left-origin.x, rect.top-origin.y, rect.right-origin.x, rect.bottom-origin.y);
-		SelectObject (drawingContext, prevBrush);
 	}
 
 } /* drawRectangle */
@@ -1147,7 +1533,11 @@ void Canvas :: drawText (const char *s)
 
 	if (len > 0)
 	{
-		TextOut (drawingContext, canvas_penpos.x-origin.x, canvas_penpos.y-origin.y, s, len);
+		tellerPlus (T_Tekenen);
+		tellerPlus (T_GdiAanroep);
+		target.moveTo (target.pen_pos.x-origin.x, target.pen_pos.y-origin.y);	// TextOut starts at the current position (TA_UPDATECP)
+		TextOut (drawingContext, target.pen_pos.x-origin.x, target.pen_pos.y-origin.y, s, len);
+		target.dc_pos_known = false;		// and moves it to the end of the text
 	}
 }	/* drawText */
 
@@ -1155,15 +1545,15 @@ void Canvas :: drawOval (GPOINT corner1, GPOINT corner2)
 {
 	if (corner1.valid () && corner2.valid ())
 	{
-		HGDIOBJ prevBrush;
 		RECT rect;
 		GPOINT origin = getOrigin ();
 
 		pointsToRect (origin, corner1, corner2, &rect);
+		tellerPlus (T_Tekenen);
+		tellerPlus (T_GdiAanroep);
 
-		prevBrush = SelectObject (drawingContext, canvas_gui.nullBrush);
+		target.selectBrush (target.null_brush);
 		Ellipse (drawingContext, rect.left-origin.x, rect.top-origin.y, rect.right-origin.x, rect.bottom-origin.y);
-		SelectObject (drawingContext, prevBrush);
 	}
 
 } /* drawOval */
@@ -1176,6 +1566,9 @@ void Canvas :: fillRectangle (GPOINT corner1, GPOINT corner2)
 		GPOINT origin = getOrigin ();
 
 		pointsToRect (origin, corner1, corner2, &rect);
+		tellerPlus (T_Tekenen);
+		tellerPlus (T_GdiAanroep);
+		target.selectBrush (target.colour_brush);
 		Rectangle (drawingContext, rect.left-origin.x, rect.top-origin.y, rect.right-origin.x, rect.bottom-origin.y);
 	}
 
@@ -1189,13 +1582,15 @@ void Canvas :: fillOval (GPOINT corner1,  GPOINT corner2)
 		GPOINT origin = getOrigin ();
 
 		pointsToRect (origin, corner1, corner2, &rect);
+		tellerPlus (T_Tekenen);
+		tellerPlus (T_GdiAanroep);
+		target.selectBrush (target.colour_brush);
 		Ellipse (drawingContext, rect.left-origin.x, rect.top-origin.y, rect.right-origin.x, rect.bottom-origin.y);
 	}
 } /* fillOval */
 
 void Canvas :: drawPolygon (GPOINT points [], int size)
 {
-	HGDIOBJ prevBrush;
 	GPOINT origin = getOrigin ();
 	GPOINT p;
 
@@ -1205,9 +1600,10 @@ void Canvas :: drawPolygon (GPOINT points [], int size)
 		points [i].y = points [i].y - origin.y;
 	}
 
-	prevBrush = SelectObject (drawingContext, canvas_gui.nullBrush);
+	tellerPlus (T_Tekenen);
+	tellerPlus (T_GdiAanroep);
+	target.selectBrush (target.null_brush);
 	Polygon (drawingContext, points, size);
-	SelectObject (drawingContext, prevBrush);
 
 } /* drawPolygon */
 
@@ -1222,19 +1618,36 @@ void Canvas :: fillPolygon	(GPOINT points [], int size)
 		points [i].y = points [i].y - origin.y;
 	}
 
+	tellerPlus (T_Tekenen);
+	tellerPlus (T_GdiAanroep);
+	target.selectBrush (target.colour_brush);
 	Polygon (drawingContext, points, size);
 
 } /* fillPolygon */
 
+void Canvas :: drawImage (BitmapTarget& image, GPOINT corner)
+{
+	drawImage (image, corner, image.getSize ());
+} /* drawImage */
+
+void Canvas :: drawImage (BitmapTarget& image, GPOINT corner, GSIZE part)
+{
+	GPOINT origin = getOrigin ();
+
+	tellerPlus (T_Tekenen);
+	tellerPlus (T_GdiAanroep);
+	BitBlt (drawingContext, corner.x-origin.x, corner.y-origin.y, part.cx, part.cy, image.target_dc, 0, 0, SRCCOPY);
+} /* drawImage */
+
 void Canvas :: setFont (GFONT font)
 {
-	canvas_gui.font = font;
-	font.setFont (drawingContext);
+	font.setFont (drawingContext);		// first, so that the previous font is no longer selected when it is deleted
+	target.font = font;
 }
 
 GFONT Canvas :: getFont ()
 {
-	return canvas_gui.font;
+	return target.font;
 }
 
 int	Canvas :: getFontHeight ()
@@ -1277,8 +1690,8 @@ void GUITerminated :: report () const
 		case GUITerminated :: GFK_Active:
 			makeAlert ("GUI is already active");
 			return;
-		case GUITerminated :: GFK_MultipleCanvas:
-			makeAlert ("More than one active canvas");
+		case GUITerminated :: GFK_NoBitmap:
+			makeAlert ("Could not create an off-screen bitmap");
 			return;
 		default:
 			makeAlert ("An unknown GUI error.");
@@ -1334,17 +1747,18 @@ GFONT :: GFONT (const char name [], int si, FStyle st)
 	newFont = CreateFontIndirect (&fontDescription);
 
 	if (newFont != NULL)
-		theFont = newFont;
+		theFont = make_shared<GdiObject> (newFont);
 }
 
 GFONT :: GFONT ()
+	: GFONT ("Times New Roman", 10, Plain)		// PA: Tijdelijk voor vast font gekozen. Kan vast beter.
 {
-	GFONT ("Times New Roman", 10, Plain);		// PA: Tijdelijk voor vast font gekozen. Kan vast beter.
 }
 
 void GFONT :: setFont (HDC drawingContext)
 {
-        SelectObject (drawingContext,theFont);
+	if (theFont)
+		SelectObject (drawingContext,theFont -> get ());
 }
 
 
@@ -1362,6 +1776,7 @@ bool FileSelector :: get (char * name)
 {
 	bool fileSelected = false;
 	OPENFILENAME ofn;
+	char file [MAX_PATH];
 
 	ofn.lStructSize       = sizeof (OPENFILENAME);
 	ofn.hwndOwner         = NULL;
@@ -1370,7 +1785,7 @@ bool FileSelector :: get (char * name)
 	ofn.lpstrCustomFilter = NULL;
 	ofn.nMaxCustFilter    = 0;
 	ofn.nFilterIndex      = 0;
-	ofn.lpstrFile         = (LPSTR) malloc (MAX_PATH);
+	ofn.lpstrFile         = file;
 	ofn.lpstrFile[0]      = '\0';
 	ofn.nMaxFile          = MAX_PATH;
 	ofn.lpstrFileTitle    = NULL;
@@ -1391,7 +1806,6 @@ bool FileSelector :: get (char * name)
 		strncpy (name, ofn.lpstrFile, MAX_PATH);
 	else
 		name [0] = '\0';
-	free (ofn.lpstrFile);
 	return fileSelected;
 }
 
@@ -1399,6 +1813,7 @@ bool FileSelector :: put (char *name)
 {
 	bool fileSelected = false;
 	OPENFILENAME ofn;
+	char file [MAX_PATH];
 
 	ofn.lStructSize       = sizeof (OPENFILENAME);
 	ofn.hwndOwner         = NULL;
@@ -1406,7 +1821,7 @@ bool FileSelector :: put (char *name)
 	ofn.lpstrCustomFilter = NULL;
 	ofn.nMaxCustFilter    = 0;
 	ofn.nFilterIndex      = 0;
-	ofn.lpstrFile         = (LPSTR) malloc (MAX_PATH);
+	ofn.lpstrFile         = file;
 	ofn.lpstrFile[0]      = '\0';
 	ofn.nMaxFile          = MAX_PATH;
 	ofn.lpstrFileTitle    = NULL;
@@ -1426,7 +1841,6 @@ bool FileSelector :: put (char *name)
 		strncpy (name, ofn.lpstrFile, MAX_PATH);
 	else
 		name [0] = '\0';
-	free (ofn.lpstrFile);
 	return fileSelected;
 }
 
@@ -1485,29 +1899,26 @@ LRESULT CALLBACK GUI :: DrawingWindowProc (HWND hwnd, UINT iMsg, WPARAM wParam,
 				int wNotifyCode = HIWORD(wParam);
 				HWND hwndCtl = (HWND) lParam;
 
-				if (wNotifyCode == 0 && hwndCtl == NULL)
-				{	// WM_COMMAND generated from a menu
-					MenuItems *menus = gui->gui_menus;
-					int index = (int)LOWORD(wParam);	// Menu elements are numbered from 1
-					int searchedMenus = 0;
-
-					while (index >= 0 && searchedMenus < gui->gui_nr_of_menus)
+				if ((wNotifyCode == 0 || wNotifyCode == 1) && hwndCtl == NULL)
+				{	// WM_COMMAND generated from a menu (0) or a keyboard shortcut (1)
+					size_t id = LOWORD(wParam);
+					if (id < gui->gui_commands.size ())
 					{
-						MenuItem *items = menus[searchedMenus];
-						while (index > 0 && items->mi_next != NULL)
-						{
-							index--;
-							items = items->mi_next;
-						};
-						if (index > 0)
-						{
-							searchedMenus++;
-						}
-						else
+						const Command command = gui->gui_commands [id];
+						if (command.callback != NULL && (gui->gui_busy == 0 || command.live))
 						{
-							items->mi_action ();
+							gui->gui_busy++;
+							try
+							{
+								gui->MenuCommand (command.callback);
+							}
+							catch (...)
+							{
+								gui->gui_busy--;
+								throw;
+							}
+							gui->gui_busy--;
 						}
-						index--;
 					}
 				}
 				return 0;
@@ -1547,8 +1958,8 @@ LRESULT CALLBACK GUI :: DrawingWindowProc (HWND hwnd, UINT iMsg, WPARAM wParam,
 
 				gui->mouse_is_down = true;
 
-				x = gui->canvas_origin.x + (int) LOWORD(lParam);
-				y = gui->canvas_origin.y + (int) HIWORD(lParam);
+				x = gui->gui_target.origin.x + (int) LOWORD(lParam);
+				y = gui->gui_target.origin.y + (int) HIWORD(lParam);
 				mouseInfo.mouseState = MouseDown;
 				mouseInfo.mousePos.x = x;
 				mouseInfo.mousePos.y = y;
@@ -1563,8 +1974,8 @@ LRESULT CALLBACK GUI :: DrawingWindowProc (HWND hwnd, UINT iMsg, WPARAM wParam,
 
 				if (gui->mouse_is_down)
 				{
-					x = gui->canvas_origin.x + (int) LOWORD(lParam);
-					y = gui->canvas_origin.y + (int) HIWORD(lParam);
+					x = gui->gui_target.origin.x + (int) LOWORD(lParam);
+					y = gui->gui_target.origin.y + (int) HIWORD(lParam);
 					mouseInfo.mouseState = MouseTrack;
 					mouseInfo.mousePos.x = x;
 					mouseInfo.mousePos.y = y;
@@ -1580,8 +1991,8 @@ LRESULT CALLBACK GUI :: DrawingWindowProc (HWND hwnd, UINT iMsg, WPARAM wParam,
 
 				gui->mouse_is_down = false;
 
-				x = gui->canvas_origin.x + (int) LOWORD(lParam);
-				y = gui->canvas_origin.y + (int) HIWORD(lParam);
+				x = gui->gui_target.origin.x + (int) LOWORD(lParam);
+				y = gui->gui_target.origin.y + (int) HIWORD(lParam);
 				mouseInfo.mouseState = MouseUp;
 				mouseInfo.mousePos.x = x;
 				mouseInfo.mousePos.y = y;
@@ -1596,10 +2007,10 @@ LRESULT CALLBACK GUI :: DrawingWindowProc (HWND hwnd, UINT iMsg, WPARAM wParam,
 				RECT updateRect;
 
 				BeginPaint (hwnd, &ps);
-				updateRect.left   = ps.rcPaint.left   + gui->canvas_origin.x;
-				updateRect.top    = ps.rcPaint.top    + gui->canvas_origin.y;
-				updateRect.right  = ps.rcPaint.right  + gui->canvas_origin.x;
-				updateRect.bottom = ps.rcPaint.bottom + gui->canvas_origin.y;
+				updateRect.left   = ps.rcPaint.left   + gui->gui_target.origin.x;
+				updateRect.top    = ps.rcPaint.top    + gui->gui_target.origin.y;
+				updateRect.right  = ps.rcPaint.right  + gui->gui_target.origin.x;
+				updateRect.bottom = ps.rcPaint.bottom + gui->gui_target.origin.y;
 				gui->Window (updateRect);
 				EndPaint (hwnd, &ps);
 				return 0;
@@ -1617,9 +2028,9 @@ LRESULT CALLBACK GUI :: DrawingWindowProc (HWND hwnd, UINT iMsg, WPARAM wParam,
 				newHeight = (int)HIWORD(lParam);
 				scrollInfo.fMask = SIF_POS;					// Retrieve thumb
 				GetScrollInfo (hwnd,SB_HORZ,&scrollInfo);
-				gui->canvas_origin.x = scrollInfo.nPos;
+				gui->gui_target.origin.x = scrollInfo.nPos;
 				GetScrollInfo (hwnd,SB_VERT,&scrollInfo);
-				gui->canvas_origin.y = scrollInfo.nPos;
+				gui->gui_target.origin.y = scrollInfo.nPos;
 
 				//	Adjust horizontal scrollbar settings:
 				maxRange = Maximum (MINCOORD,MAXCOORD-newWidth);
@@ -1627,14 +2038,14 @@ LRESULT CALLBACK GUI :: DrawingWindowProc (HWND hwnd, UINT iMsg, WPARAM wParam,
 				scrollInfo.nMin  = MINCOORD;
 				scrollInfo.nMax  = maxRange;
 				SetScrollInfo (hwnd, SB_HORZ,&scrollInfo,true);
-				newX = setbetween (gui->canvas_origin.x,MINCOORD,maxRange);
-				if (newX!=gui->canvas_origin.x)
+				newX = setbetween (gui->gui_target.origin.x,MINCOORD,maxRange);
+				if (newX!=gui->gui_target.origin.x)
 				{
 					scrollInfo.fMask  = SIF_POS | SIF_PAGE;
 					scrollInfo.nPos   = newX;
 					scrollInfo.nPage  = newWidth;
 					SetScrollInfo (hwnd,SB_HORZ,&scrollInfo,true);
-					gui->canvas_origin.x = newX;
+					gui->gui_target.origin.x = newX;
 				}
 				//	Adjust vertical scrollbar settings:
 				maxRange = Maximum (MINCOORD,MAXCOORD-newHeight);
@@ -1642,14 +2053,14 @@ LRESULT CALLBACK GUI :: DrawingWindowProc (HWND hwnd, UINT iMsg, WPARAM wParam,
 				scrollInfo.nMin  = MINCOORD;
 				scrollInfo.nMax  = maxRange;
 				SetScrollInfo (hwnd, SB_VERT, &scrollInfo, true);
-				newY = setbetween (gui->canvas_origin.y,MINCOORD,maxRange);
-				if (newY!=gui->canvas_origin.y)
+				newY = setbetween (gui->gui_target.origin.y,MINCOORD,maxRange);
+				if (newY!=gui->gui_target.origin.y)
 				{
 					scrollInfo.fMask  = SIF_POS | SIF_PAGE;
 					scrollInfo.nPos   = newY;
 					scrollInfo.nPage  = newHeight;
 					SetScrollInfo (hwnd,SB_VERT,&scrollInfo,true);
-					gui->canvas_origin.y = newY;
+					gui->gui_target.origin.y = newY;
 				}
 
 				return DefWindowProc (hwnd, iMsg, wParam, lParam);
@@ -1668,9 +2079,9 @@ LRESULT CALLBACK GUI :: DrawingWindowProc (HWND hwnd, UINT iMsg, WPARAM wParam,
 				curWidth = clientRect.right;
 				scrollInfo.fMask = SIF_POS;					// Retrieve thumb
 				GetScrollInfo (hwnd, SB_HORZ, &scrollInfo);
-				gui->canvas_origin.x = scrollInfo.nPos;
+				gui->gui_target.origin.x = scrollInfo.nPos;
 
-				curX     = gui->canvas_origin.x;
+				curX     = gui->gui_target.origin.x;
 				maxRange = Maximum (MINCOORD,MAXCOORD-curWidth);
 				newX     = curX;
 				switch (nScrollCode)
@@ -1716,7 +2127,7 @@ LRESULT CALLBACK GUI :: DrawingWindowProc (HWND hwnd, UINT iMsg, WPARAM wParam,
 							break;
 						}
 				}
-				gui->canvas_origin.x = newX;
+				gui->gui_target.origin.x = newX;
 				if (newX != curX)
 				{
 					scrollInfo.fMask = SIF_POS;
@@ -1749,9 +2160,9 @@ LRESULT CALLBACK GUI :: DrawingWindowProc (HWND hwnd, UINT iMsg, WPARAM wParam,
 				curHeight= clientRect.bottom;
 				scrollInfo.fMask = SIF_POS;					// Retrieve thumb
 				GetScrollInfo (hwnd, SB_VERT, &scrollInfo);
-				gui->canvas_origin.y = scrollInfo.nPos;
+				gui->gui_target.origin.y = scrollInfo.nPos;
 
-				curY     = gui->canvas_origin.y;
+				curY     = gui->gui_target.origin.y;
 				maxRange = Maximum (MINCOORD,MAXCOORD-curHeight);
 				newY     = curY;
 				switch (nScrollCode)
@@ -1797,7 +2208,7 @@ LRESULT CALLBACK GUI :: DrawingWindowProc (HWND hwnd, UINT iMsg, WPARAM wParam,
 							break;
 						}
 				}
-				gui->canvas_origin.y = newY;
+				gui->gui_target.origin.y = newY;
 				if (newY != curY)
 				{
 					scrollInfo.fMask = SIF_POS;
@@ -1817,8 +2228,21 @@ LRESULT CALLBACK GUI :: DrawingWindowProc (HWND hwnd, UINT iMsg, WPARAM wParam,
 				return 0;
 			}
 		case WM_DESTROY:
-			DeleteObject (gui->thePen);
-			DeleteObject (gui->theBrush);
+			{
+				const HDC dc = gui->gui_target.target_dc;
+				gui->gui_target.detach ();
+				ReleaseDC (hwnd, dc);
+				if (gui->gui_wait_timer != NULL)
+				{
+					CloseHandle (gui->gui_wait_timer);
+					gui->gui_wait_timer = NULL;
+				}
+				if (gui->gui_system_period)
+				{
+					timeEndPeriod (1);
+					gui->gui_system_period = false;
+				}
+			}
 			PostQuitMessage (0);
 			return 0;
 	}
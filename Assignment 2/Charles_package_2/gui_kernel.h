@@ -15,7 +15,16 @@
 	Last Modified:	September 16 2003, by Pieter Koopman, KUN
 *****************************************************************************************/
 
+#ifndef GUI_KERNEL_H
+#define GUI_KERNEL_H
+
 #include <windows.h>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <queue>
+#include <string>
+#include <vector>
 
 //	WINARGS are mandatory in the GUI run methods.
 struct WINARGS
@@ -138,6 +147,36 @@ class Canvas;
 class Dialog;
 
 
+/*****************************************************************************************
+	GDI objects
+*****************************************************************************************/
+
+/*	GdiObject owns a pen, brush or font that the kernel created, and deletes it when it is
+	destroyed; it can be moved, but not copied. An object that is selected in a drawing
+	context can not be deleted, so the kernel selects a stock object before it lets go of one.
+	live counts the GdiObjects that own an object (see GUI::GetResourceUsage), in all threads.
+*/
+
+class GdiObject
+{
+public:
+	explicit	GdiObject	(HGDIOBJ object = NULL);
+				GdiObject	(GdiObject&& other);
+				~GdiObject	();
+	GdiObject&	operator=	(GdiObject&& other);
+
+	HGDIOBJ		get			() const { return gdi_object; }
+	static int	live		() { return gdi_live.load (std::memory_order_relaxed); }
+
+private:
+				GdiObject	(const GdiObject&);
+	GdiObject&	operator=	(const GdiObject&);
+
+	HGDIOBJ		gdi_object;
+	static std::atomic<int>	gdi_live;
+} ;
+
+
 /*****************************************************************************************
 	Font class
 *****************************************************************************************/
@@ -156,13 +195,96 @@ public:
 	
 private:
 	int		size;
-	HFONT   theFont;
+	std::shared_ptr<GdiObject>	theFont;	// shared by the copies; NULL if it could not be created
 	FStyle	style;
 
 	void setFont	(HDC drawingContext);
 } ;
 
 
+/*****************************************************************************************
+	Render targets
+*****************************************************************************************/
+
+/*	A RenderTarget is what a Canvas draws on: the window of the GUI, or a BitmapTarget in
+	memory. Every target has a drawing context of its own, and keeps the drawing state of the
+	Canvases on it: the pen colour and position, the font, the pen and brush of every colour
+	used, the brush that is selected and the current position of the context. Canvases on
+	different targets share nothing, so they can exist at the same time, also in different
+	threads; the Canvases on one target must be used by one thread at a time, and the window
+	only by the thread that runs the GUI.
+*/
+
+class RenderTarget
+{
+	friend class Canvas;
+	friend class GUI;
+public:
+	virtual		~RenderTarget	();
+
+protected:
+				RenderTarget	();
+	void		attach			(HDC dc);		//	the target draws in dc from now on
+	void		detach			();				//	deselects the objects of the target, so that dc can be released
+
+	HDC			target_dc;		//	NULL while the target has no drawing context
+
+private:
+				RenderTarget	(const RenderTarget&);
+	RenderTarget&	operator=	(const RenderTarget&);
+
+	enum { MaxColourObjects = 64 };
+	struct ColourObjects
+	{
+		GdiObject	pen;
+		GdiObject	brush;
+	} ;
+	GPOINT		origin;				//	the point of the target at the top-left corner of the context
+	RGBCOLOUR	pen_colour;
+	COLORREF	penColour;
+	bool		in_normal_mode;
+	GFONT		font;
+	std::map<COLORREF, ColourObjects>	colour_objects;		//	the pen and brush of the colours used
+	HGDIOBJ		black_pen;
+	HGDIOBJ		black_brush;
+	HGDIOBJ		null_brush;
+	HGDIOBJ		dc_brush;			//	the brush selected in target_dc
+	HGDIOBJ		colour_brush;		//	the brush of pen_colour, for the fill operations
+	GPOINT		pen_pos;
+	POINT		dc_pos;				//	the current position of target_dc
+	bool		dc_pos_known;		//	false after an operation that moves it by itself (TextOut)
+
+	const ColourObjects&	colourObjects			(COLORREF colour);
+	void					releaseColourObjects	();
+	void					selectBrush				(HGDIOBJ brush);
+	void					moveTo					(int x, int y);
+} ;
+
+/*	A BitmapTarget is an image in memory that a Canvas can draw on without a window; it is
+	white when it is made. Canvas::drawImage copies it to another target. Its pixels can also
+	be used directly: pixels returns the rows from top to bottom, getSize().cx 0x00RRGGBB
+	values each, after the drawing operations so far have been done. The constructor throws
+	GUITerminated (GFK_NoBitmap) when Windows can not make the image.
+*/
+
+class BitmapTarget : public RenderTarget
+{
+public:
+	explicit	BitmapTarget	(GSIZE size);
+				~BitmapTarget	();
+
+	GSIZE		getSize			() const { return bitmap_size; }
+	DWORD*		pixels			();
+	void		clear			(RGBCOLOUR colour);
+
+private:
+	GSIZE		bitmap_size;
+	GdiObject	bitmap;
+	HGDIOBJ		old_bitmap;			//	selected in target_dc before bitmap
+	DWORD		*bitmap_bits;
+} ;
+
+
 /*****************************************************************************************
 	Menu class
 *****************************************************************************************/
@@ -170,12 +292,34 @@ private:
 //	The prototypes of the program defined menu callback procedures.
 
 typedef void (*MenuCallBack) ();
-typedef struct MenuItem *MenuItems;
 typedef class Menu *Menus;
 
+//	Modifier keys of a keyboard shortcut; they can be combined with |.
+enum ShortcutModifier
+	{	NoModifier	= 0
+	,	ShiftKey	= FSHIFT
+	,	ControlKey	= FCONTROL
+	,	AltKey		= FALT
+	} ;
+
+struct MenuItem
+{
+	std::string		mi_title;		//	the title, including the name of the shortcut
+	MenuCallBack	mi_action;		//	the callback procedure; NULL for a separator
+	char			mi_key;			//	the shortcut key ('A'..'Z', '0'..'9'); 0 if none
+	int				mi_modifiers;	//	the ShortcutModifiers of the shortcut
+
+					MenuItem (const char *title, MenuCallBack action, char key = 0, int modifiers = NoModifier);
+} ;
+
 /*	Menu:	Constructor that creates a new menu with the indicated name
 	add:	Appends the item to the argument menu at the end.
-			When the argument is not specified a separator is added
+			When the argument is not specified a separator is added.
+			An item can have a keyboard shortcut: key is an upper case letter or a
+			digit, modifiers is a combination of ShortcutModifiers (ControlKey by default).
+			The shortcut is shown after the title of the item.
+	setLive: The items of the menu can also be chosen while another menu command
+			is running (see GUI::ProcessMessages). Items of other menus are ignored then.
 */
 	
 class Menu	
@@ -183,13 +327,17 @@ class Menu
 	friend class GUI;
 public:
 				Menu	(char *);
+				~Menu	();
 	Menu&		add		(char *, MenuCallBack);
+	Menu&		add		(char *, MenuCallBack, char key, int modifiers = ControlKey);
 	Menu&		add		(void);
+	Menu&		setLive	(void);
 private:
-	MenuItems		menu_call_backs; 	//  a list of callback procedures
-	char			*menu_title;		//	the title
-	Menus			menu_next;
-	static Menus	menu_bar;
+	std::vector<MenuItem>	menu_items;		//	the items, in the order in which they were added
+	char					*menu_title;	//	the title
+	bool					menu_live;		//	the items can be chosen while a command runs
+
+	static std::vector<Menus>	menu_bar;	//	all menus, in the order in which they were created
 };
 
 
@@ -201,6 +349,7 @@ private:
 		* Keyboard			(handles all keyboard input in the window)
 		* Mouse				(handles all mouse input in the window)
 		* Timer				(handles all timer events in the window)
+		* MenuCommand		(runs a menu command; by default it only calls it)
 	
 	There is always one window associated with a GUI in which one can indicate
 	the desired origin.
@@ -208,6 +357,18 @@ private:
 	A GUI-application needs to be triggered by invoking the 'Run' method. Two versions
 	of 'Run' are available: one for an application that contains a menu and one
 	for a menu-less application.
+	'Open' only creates and shows the window, without entering the event loop. It is
+	meant for batch programs (such as the benchmarks) that draw without user interaction.
+	'Run' can not be used after 'Open'.
+	
+	ProcessMessages lets the application react to the user while a menu command runs
+	for a long time: it waits at most wait milliseconds for input or a due timer, and
+	then handles all pending messages and timers. During a menu command only the items
+	of live menus (see Menu::setLive) can be chosen. The result is false once the window
+	has been closed. CommandsRunning is the number of menu commands that run at the moment:
+	more than one while a live command runs during another. MenuCommand is called with the
+	command of a chosen menu item; a derived class can redefine it to catch the exceptions
+	its commands throw.
 	
 	Termination operations:
 
@@ -234,11 +395,53 @@ private:
 	*	dt:				The timer interval. If negative it will be set to zero. It is
 						not guaranteed that the timer will be called at exactly the
 						indicated interval.
+
+	addTimer starts an additional timer that calls callback (id, argument) every dt
+	milliseconds, and returns its id. Any number of timers can run at the same time, each
+	at its own interval; dt can be a fraction of a millisecond. removeTimer stops a timer;
+	it may be called from within its own callback. The timer of startTimer is one of them.
+	All timers are kept in one priority queue ordered by their next moment, which is
+	measured on the high resolution performance counter. The next moment of a timer is
+	computed from its previous moment, not from the moment its callback returned, so
+	timers do not drift; ticks that were missed because a callback took too long are
+	skipped. The event loop waits for both the next message and the first due timer with
+	a single MsgWaitForMultipleObjectsEx call, on a waitable timer set to the moment the
+	timer is due, so it does not spin while it waits. On Windows 10 (1803) and later that
+	is a high resolution timer, which ends the wait within about half a millisecond;
+	before that the system timer is set to a resolution of 1 ms (timeBeginPeriod). A timer
+	with a shorter interval than that resolution is called once per wake-up: its missed
+	ticks are skipped.
+
+	Resource usage:
+
+	GetResourceUsage reports what the application uses, for a debug monitor: the GDI and
+	USER objects that Windows counts for the process, the pens, brushes and fonts that the
+	kernel owns, the colours whose pen and brush are kept, and the blocks and bytes in use
+	on the heap of the C library. In a long session these numbers should stay flat. Walking
+	the heap takes time in proportion to its blocks, on the thread of the window, so the heap
+	is walked at most once every HeapSampleInterval milliseconds; in between the numbers of
+	the last walk are reported again.
+	Every colour gets its pen and brush once, when it is first used; at most
+	MaxColourObjects colours are kept, after which they are all deleted and made again
+	when needed.
 	 
 *****************************************************************************************/
 
 typedef struct DialogRepr *DialogHandle; 
 
+struct ResourceUsage
+{
+	DWORD		gdi_objects;		//	of the process, as counted by Windows
+	DWORD		user_objects;		//	windows, menus, accelerator tables, ...
+	int			kernel_objects;		//	the GdiObjects that own an object
+	int			colours;			//	the colours whose pen and brush the window keeps
+	size_t		heap_blocks;		//	in use on the heap of the C library
+	size_t		heap_bytes;
+} ;
+
+typedef int TimerId;
+typedef void (*TimerCallBack) (TimerId, void *argument);
+
 class GUI
 {
 public:
@@ -246,12 +449,19 @@ public:
 
 	void		Run					(WINARGS winArgs);
 	void		Run					(Menu& menu, WINARGS winArgs);
+	void		Open				(WINARGS winArgs);
+	bool		ProcessMessages		(double wait = 0);
 
 	GSIZE		getWindowSize		();
 	void		startTimer			(int);
 	void 		stopTimer			();
+	TimerId		addTimer			(double dt, TimerCallBack callback, void *argument = NULL);
+	void		removeTimer			(TimerId);
 	void		Activate			();
 	void		Stop				();
+	ResourceUsage	GetResourceUsage	();
+	enum { HeapSampleInterval = 5000 };
+	int			CommandsRunning		() const { return gui_busy; }
 
 	static void		Beep			(int);
 
@@ -259,6 +469,7 @@ public:
 	virtual void	Mouse		(const MOUSEINFO& mouse_info)	{}
 	virtual void	Keyboard	(const KEYINFO& key_info)		{}
 	virtual void	Timer		(const int dt)					{}
+	virtual void	MenuCommand	(MenuCallBack command)			{ command (); }
 
 
 	friend class Canvas;
@@ -268,43 +479,51 @@ private:
 	const GUI& operator=(const GUI&);	// empty assignment-operator; prevents duplication
 	struct TimerDef
 	{
-		UINT	timer_period;
-		UINT	timerID;
+		LONGLONG		period;			//	in ticks of the performance counter
+		LONGLONG		next;			//	the next moment the timer is due
+		TimerCallBack	callback;		//	NULL if the timer is not in use
+		void			*argument;
+		unsigned		generation;		//	incremented when the timer is removed
+	} ;
+	struct TimerDue						//	an entry of the priority queue of timers
+	{
+		LONGLONG		next;
+		TimerId			id;
+		unsigned		generation;		//	the entry is stale if it differs from the timer's
 
-				TimerDef ()
-					: timer_period(0),timerID(0)
-				{}
+		bool operator< (const TimerDue& other) const { return next > other.next; }
 	} ;
 
 //	HDC				drawingContext;
 	HWND			the_window;
 	DialogHandle	the_dialogs;
 
-	GPOINT		canvas_origin;
-	RGBCOLOUR	pen_colour;
-	COLORREF	penColour;
-	bool		in_normal_mode;
-	GFONT		font;
+	RenderTarget	gui_target;		//	the window; it has a drawing context from its creation until WM_DESTROY
 	GSIZE		windowSize;
 	char		*windowTitle;
 	
-	HPEN		thePen;
-	HBRUSH		theBrush;
-	HGDIOBJ		blackPen;
-	HGDIOBJ		whitePen;
-	HGDIOBJ		nullPen;
-	HGDIOBJ		blackBrush;
-	HGDIOBJ		whiteBrush;
-	HGDIOBJ		nullBrush;
-	
-	MenuItems	*gui_menus;
-	int			gui_nr_of_menus;
-	TimerDef	gui_timer;
+	struct Command
+	{
+		MenuCallBack	callback;		//	NULL for a separator
+		bool			live;			//	can be chosen while another command runs
+	} ;
+	std::vector<Command>		gui_commands;		//	the menu command of each command id
+	int							gui_busy;			//	the number of running menu commands
+	HACCEL						gui_accelerators;	//	the keyboard shortcuts of the menus; NULL if none
+	std::vector<TimerDef>			gui_timers;			//	indexed by TimerId
+	std::priority_queue<TimerDue>	gui_due;			//	the earliest timer on top
+	TimerId							gui_timer;			//	the timer of startTimer; -1 if stopped
+	int								gui_timer_period;	//	the interval of startTimer in milliseconds
+	HANDLE							gui_wait_timer;		//	ends the wait of the event loop when the first timer is due; NULL if none
+	bool							gui_system_period;	//	timeBeginPeriod (1) was called for it
+	size_t							gui_heap_blocks;	//	found by the last walk of the heap (GetResourceUsage)
+	size_t							gui_heap_bytes;
+	DWORD							gui_heap_walked;	//	the GetTickCount of that walk; 0 if none yet
 	bool		mouse_is_down;
 	bool		quitRequested;
 
 	void InitialiseDrawingLibrary (WINARGS winArgs);
-	static VOID    CALLBACK EvaluateTimer     (HWND hwnd, UINT uMsg, UINT idEvent, DWORD dwTime);
+	static void             EvaluateTimer     (TimerId id, void *gui);
 	static LRESULT CALLBACK DrawingWindowProc (HWND hwnd, UINT iMsg, WPARAM wParam, LPARAM lParam);
 
 	static bool drawing_library_initialised;
@@ -313,6 +532,10 @@ private:
 	
 	void 		RunGUI 				(void);
 	void 		insertMenus 		(Menus menus);
+	void		evaluateTimers		(void);
+	void		dispatchMessages	(void);
+	LONGLONG	nextTimerDue		(void);
+	void		waitForInput		(LONGLONG until);
 
 };
 
@@ -378,7 +601,15 @@ private:
 
 /*****************************************************************************************
 	For drawing one needs a 'Canvas' object. The constructor expects a GUI object as
-	argument.
+	argument, to draw in its window, or a RenderTarget, such as a BitmapTarget.
+
+	A Canvas is a view on the drawing context of its target. The GUI acquires the context
+	of the window once, when the window is created, and keeps it until it is destroyed (the
+	window class has CS_OWNDC, so what is selected in it stays selected). Creating a Canvas
+	makes no GDI call, and several may exist at the same time; the pen colour, pen position
+	and font belong to the target, so they carry over from one Canvas to the next. The
+	target remembers the brush that is selected and the current position of the context, so
+	an operation only selects a brush or moves the position when that changes something.
 
 	---------------------------------------------------------------------------------------
 	
@@ -427,6 +658,22 @@ private:
 	Actions:
 	Toggles drawing mode of the canvas to XOR mode and normal mode.
 
+	---------------------------------------------------------------------------------------
+
+	void drawImage (BitmapTarget& image, GPOINT corner)
+
+	Actions:
+	Copies image to the canvas, with its top-left corner at corner. No other thread may
+	draw on image meanwhile.
+
+	---------------------------------------------------------------------------------------
+
+	void drawImage (BitmapTarget& image, GPOINT corner, GSIZE part)
+
+	Actions:
+	As drawImage (image, corner), but copies only the top-left part.cx x part.cy pixels of
+	image.
+
 *****************************************************************************************/
 
 class Canvas
@@ -435,6 +682,7 @@ class Canvas
 
 public:
 			Canvas			(GUI &gui);
+			Canvas			(RenderTarget &target);
 			~Canvas			();
 
 	void		setPenColour 	(RGBCOLOUR);
@@ -458,12 +706,13 @@ public:
 	void		fillRectangle	(GPOINT, GPOINT);
 	void		fillOval		(GPOINT, GPOINT);
 	void		fillPolygon		(GPOINT points [], int size);
+	void		drawImage		(BitmapTarget& image, GPOINT corner);
+	void		drawImage		(BitmapTarget& image, GPOINT corner, GSIZE part);
 	GPOINT		getOrigin		()
-				{	return canvas_gui.canvas_origin; }
+				{	return target.origin; }
 private:
-	GUI		&canvas_gui;
-	HDC		 drawingContext;
-	static bool canvas_created;
+	RenderTarget	&target;
+	HDC				drawingContext;
 
 } ;
 
@@ -485,7 +734,7 @@ class GUITerminated : public GUIException
 public:
 	enum GUIFailureKind
 	{
-		GFK_InitializationError, GFK_MultipleGUIs, GFK_Active, GFK_MultipleCanvas
+		GFK_InitializationError, GFK_MultipleGUIs, GFK_Active, GFK_NoBitmap
 	};
 	GUITerminated (GUIFailureKind st)
 		: status (st)
@@ -512,3 +761,5 @@ public:
 private:
 	DialogFailureKind status;
 } ;
+
+#endif
@@ -0,0 +1,554 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+	Evaluator is a console program that runs robot programs written in the text language of
+	Vertaler.h on the headless world, without a window, and reports for every program whether
+	it finished, how many instructions and actions it took, and how long compiling and running
+	took. Every program starts in a fresh copy of the same world.
+
+	Usage: Evaluator [--world file | --maze kind:seed:WxH | --campaign kind:count[:WxH]] [--seed n] [--threads g,e] [--queue n]
+	                 [--max n] [--no-optimise] [--task task] [--out file.json] program...
+
+	--world		the world to start in, in the format of nieuweWereld (default: the empty world)
+	--maze		start in a generated maze (Doolhof.h) instead, such as backtracker:7:2001x2001;
+				kind is backtracker, kruskal or wilson, and the same seed gives the same maze
+	--campaign	run every program on 'count' generated worlds instead (Campagne.h): kind is cave,
+				chaos, path or maze, the size is at least 20x20 (default 50x30); world i is
+				generated from seed + i (--seed, default 1). g generator threads feed e
+				evaluator threads (--threads, default a quarter and the rest of the processors)
+				through a queue of n worlds (--queue, default 64). A task is solved again on
+				every world.
+	--max		the maximum number of instructions per program (default: 1000000000)
+	--no-optimise	run the program as compiled, without optimaliseer (Optimalisatie.h); the
+				optimised program takes fewer instructions and counts fewer tests as actions
+	--task		score the programs against a reference solution of a task (Oplosser.h):
+				reach:x,y (walk to a field), collect (pick up every ball) or fill (put a ball
+				on every empty field Charles can reach)
+	--out		write the results to a file instead of standard output
+
+	The results are JSON:
+
+	{
+	  "schema": 1,
+	  "programs": [
+	    { "program": "walk.karel", "status": "finished", "instructions": 1234, "actions": 617, "compile_ms": 0.012, "run_ms": 0.004 },
+	    { "program": "bump.karel", "status": "illegal_action", "illegal_action": "step", ... },
+	    { "program": "typo.karel", "status": "compile_error", "message": "typo.karel:3: ..." }
+	  ]
+	}
+
+	With --task the results also have "reference": { "task": "collect", "found": true,
+	"actions": 42, "optimal": true }, the number of primitives of the shortest solution, and
+	every program gets "primitives" (its actions without the tests), "task_done" and
+	"efficiency": the reference actions divided by its primitives, 0 if the task was not done.
+
+	status is finished, budget_exhausted, illegal_action, program_error (such as too deep
+	recursion) or compile_error.
+
+	A campaign reports every program over all worlds: "worlds", "finished" (the number of
+	worlds on which it finished), the sums of "instructions", "actions" and "run_ms", and with
+	a task "task_done" (a number of worlds) and the mean "efficiency". Next to "programs" is
+	"campaign", with per stage ("generation", "evaluation") the worlds, the "busy_ms" and
+	"waiting_ms" of its threads together, and "worlds_per_second" while busy; and the
+	"queue_high_water", the most worlds that waited in the queue at once. "worlds_allocated"
+	tells how many worlds were made on the heap (the others were used again), and "arena" what
+	the runs took from the arenas of the evaluator threads: the "allocations" and "bytes", the
+	"blocks" the arenas asked from the heap, and the "high_water_bytes" of one world.
+
+	The exit code is 0 when every program finished (on every world), and 1 otherwise.
+*/
+
+#include "Campagne.h"
+#include "Doolhof.h"
+#include "Machine.h"
+#include "Optimalisatie.h"
+#include "Oplosser.h"
+#include "Vertaler.h"
+
+using namespace std;
+
+static double nu_ms ()
+{
+	return chrono::duration_cast<chrono::nanoseconds> (chrono::steady_clock::now ().time_since_epoch ()).count () / 1e6;
+}
+
+static string alsJSON (const string& tekst)
+{
+	string json = "\"";
+	for (size_t i = 0; i < tekst.size (); i++)
+	{
+		const unsigned char c = tekst [i];
+		if (c == '"' || c == '\\')
+			json += '\\';
+		if (c < ' ')
+			json += ' ';
+		else
+			json += c;
+	}
+	return json + "\"";
+}
+
+static const char *actieNaam (IllegaleActies ia)
+{
+	switch (ia)
+	{
+		case IA_Karel:			return "karel";
+		case IA_Stap:			return "step";
+		case IA_PakBal:			return "get_ball";
+		case IA_LegBal:			return "put_ball";
+		case IA_Open:			return "open";
+		case IA_Limiet:			return "limit";
+		case IA_Onderbroken:	return "interrupted";
+		case IA_Gesloten:		return "closed";
+	}
+	return "unknown";
+}
+
+//	Taak is a task of --task; for fill, doelen are the fields that must have a ball at the end.
+struct Taak
+{
+	enum Soort { Geen, Naar, Verzamel, Vul }	soort;
+	int			x, y;
+	vector<char>	doelen;
+	Oplossing	referentie;
+} ;
+
+static bool leesTaak (const char *tekst, Taak& taak)
+{
+	if (strcmp (tekst, "collect") == 0)
+		taak.soort = Taak::Verzamel;
+	else if (strcmp (tekst, "fill") == 0)
+		taak.soort = Taak::Vul;
+	else if (sscanf (tekst, "reach:%d,%d", &taak.x, &taak.y) == 2)
+		taak.soort = Taak::Naar;
+	else
+		return false;
+	return true;
+}
+
+//	Doolhof is a maze of --maze.
+struct Doolhof
+{
+	DoolhofSoort		soort;
+	unsigned long long	zaad;
+	int					breedte, hoogte;
+} ;
+
+static bool leesDoolhof (const char *tekst, Doolhof& doolhof)
+{
+	char soort [16];
+	if (sscanf (tekst, "%15[a-z]:%llu:%dx%d", soort, &doolhof.zaad, &doolhof.breedte, &doolhof.hoogte) != 4
+		|| doolhof.breedte < 3 || doolhof.hoogte < 3)
+		return false;
+	for (int s = 0; s < AantalDoolhofSoorten; s++)
+		if (strcmp (soort, doolhofNaam ((DoolhofSoort) s)) == 0)
+		{
+			doolhof.soort = (DoolhofSoort) s;
+			return true;
+		}
+	return false;
+}
+
+static const char *taakNaam (Taak::Soort soort)
+{
+	switch (soort)
+	{
+		case Taak::Naar:		return "reach";
+		case Taak::Verzamel:	return "collect";
+		case Taak::Vul:			return "fill";
+		case Taak::Geen:		break;
+	}
+	return "none";
+}
+
+//	bereidVoor solves the task once, on the world every program starts in.
+static bool bereidVoor (Taak& taak, const Wereld& wereld)
+{
+	switch (taak.soort)
+	{
+		case Taak::Naar:
+			if (taak.x < 0 || taak.y < 0 || taak.x >= wereld.breedte () || taak.y >= wereld.hoogte ())
+				return false;
+			taak.referentie = naarVeld (wereld, taak.x, taak.y);
+			break;
+		case Taak::Verzamel:
+			taak.referentie = pakBallen (wereld);
+			break;
+		case Taak::Vul:
+			taak.doelen		= grotVelden (wereld);
+			taak.referentie	= bezoek (wereld, taak.doelen, OP_LegBal);
+			break;
+		case Taak::Geen:
+			break;
+	}
+	return true;
+}
+
+static bool gedaan (const Taak& taak, const Wereld& wereld)
+{
+	switch (taak.soort)
+	{
+		case Taak::Naar:
+			return wereld.x () == taak.x && wereld.y () == taak.y;
+		case Taak::Verzamel:
+			for (int y = 0; y < wereld.hoogte (); y++)
+				if (wereld.ballen ().eersteInRij (y, 0, wereld.breedte (), true) < wereld.breedte ())
+					return false;
+			return true;
+		case Taak::Vul:
+			for (int x = 0; x < wereld.breedte (); x++)
+				for (int y = 0; y < wereld.hoogte (); y++)
+					if (taak.doelen [x * wereld.hoogte () + y] && wereld.veld (x, y) != Bal)
+						return false;
+			return true;
+		case Taak::Geen:
+			break;
+	}
+	return false;
+}
+
+//	Uitslag is the result of a run of a program on one world.
+struct Uitslag
+{
+	string		status, extra;		//	extra: the JSON members that explain the status
+	bool		geslaagd;			//	the program finished
+	bool		taak_gedaan;
+	long long	instructies, acties, primitieven;
+	double		run_ms, efficientie;
+} ;
+
+//	vertaal compiles a program; false and a JSON member "message" if it has an error.
+static bool vertaal (const string& bestand, bool optimaliseren, Programma& programma, string& melding)
+{
+	try
+	{
+		programma = Vertaler::laad (bestand);
+		if (optimaliseren)
+			programma = optimaliseer (programma);
+		return true;
+	}
+	catch (ProgrammaFout& f)
+	{
+		melding = ", \"message\": " + alsJSON (f.melding ());
+		return false;
+	}
+}
+
+//	draai runs a compiled program on a copy of begin_wereld; the copy and the machine are kept in arena, if there is one.
+static Uitslag draai (const Programma& programma, const Wereld& begin_wereld, long long maximum, const Taak& taak, Arena *arena = 0)
+{
+	Uitslag uitslag;
+	uitslag.status		= "finished";
+	uitslag.geslaagd	= false;
+
+	const double begin = nu_ms ();
+	Wereld wereld (begin_wereld, arena);
+	Machine machine (programma, wereld, arena);
+	try
+	{
+		machine.voerUit (maximum);
+		if (machine.gestopt ())
+			uitslag.geslaagd = true;
+		else
+			uitslag.status = "budget_exhausted";
+	}
+	catch (IllegaleActie& ia)
+	{
+		uitslag.status = "illegal_action";
+		uitslag.extra  = string (", \"illegal_action\": \"") + actieNaam (ia.actie ()) + "\"";
+	}
+	catch (ProgrammaFout& f)
+	{
+		uitslag.status = "program_error";
+		uitslag.extra  = ", \"message\": " + alsJSON (f.melding ());
+	}
+	uitslag.run_ms		= nu_ms () - begin;
+	uitslag.instructies	= machine.instructies ();
+	uitslag.acties		= machine.acties ();
+	uitslag.primitieven	= machine.primitieven ();
+
+	uitslag.taak_gedaan	= uitslag.geslaagd && taak.soort != Taak::Geen && gedaan (taak, wereld);	//	only a program that finished has done its task
+	uitslag.efficientie	= uitslag.taak_gedaan ? efficientie (taak.referentie, machine.primitieven ()) : 0.0;
+	return uitslag;
+}
+
+//	evalueer compiles and runs one program, and returns its result as a JSON object.
+static string evalueer (const string& bestand, const Wereld& begin_wereld, long long maximum, bool optimaliseren, const Taak& taak, bool& geslaagd)
+{
+	ostringstream uit;
+	uit << setprecision (6) << fixed;
+	uit << "{ \"program\": " << alsJSON (bestand);
+
+	geslaagd = false;
+	const double begin = nu_ms ();
+	Programma programma;
+	string melding;
+	if (!vertaal (bestand, optimaliseren, programma, melding))
+	{
+		uit << ", \"status\": \"compile_error\"" << melding << " }";
+		return uit.str ();
+	}
+	const double vertaald = nu_ms ();
+
+	const Uitslag uitslag = draai (programma, begin_wereld, maximum, taak);
+	geslaagd = uitslag.geslaagd;
+	uit << ", \"status\": \"" << uitslag.status << "\"" << uitslag.extra
+		<< ", \"instructions\": " << uitslag.instructies << ", \"actions\": " << uitslag.acties
+		<< ", \"compile_ms\": " << vertaald - begin << ", \"run_ms\": " << uitslag.run_ms;
+	if (taak.soort != Taak::Geen)
+		uit << ", \"primitives\": " << uitslag.primitieven << ", \"task_done\": " << (uitslag.taak_gedaan ? "true" : "false")
+			<< ", \"efficiency\": " << uitslag.efficientie;
+	uit << " }";
+	return uit.str ();
+}
+
+static bool leesCampagne (const char *tekst, Campagne& campagne)
+{
+	char soort [16];
+	const int gelezen = sscanf (tekst, "%15[a-z]:%d:%dx%d", soort, &campagne.aantal, &campagne.breedte, &campagne.hoogte);
+	if (gelezen != 2 && gelezen != 4)
+		return false;
+	if (gelezen == 2)
+	{
+		campagne.breedte = WereldBreedte;
+		campagne.hoogte  = WereldHoogte;
+	}
+	if (campagne.aantal < 1 || campagne.breedte < MinimaleZijde || campagne.hoogte < MinimaleZijde)
+		return false;
+	for (int s = 0; s < AantalWereldSoorten; s++)
+		if (strcmp (soort, wereldNaam ((WereldSoort) s)) == 0)
+		{
+			campagne.soort = (WereldSoort) s;
+			return true;
+		}
+	return false;
+}
+
+static void schrijfFase (ostream& uit, const char naam [], const Fase& fase, int threads)
+{
+	uit << "\"" << naam << "\": { \"worlds\": " << fase.werelden << ", \"busy_ms\": " << fase.bezig_ms << ", \"waiting_ms\": " << fase.wacht_ms
+		<< ", \"worlds_per_second\": " << (fase.bezig_ms > 0 ? fase.werelden * threads * 1000.0 / fase.bezig_ms : 0.0) << " }";
+}
+
+//	evalueerCampagne runs the compiled programs on every world of the campaign, and writes the totals per program.
+static int evalueerCampagne (const Campagne& campagne, char *bestanden [], int aantal, long long maximum, bool optimaliseren, const Taak& taak, ostream& uit)
+{
+	vector<Programma>	programmas (aantal);
+	vector<string>		meldingen (aantal);
+	vector<bool>		vertaald (aantal);
+	for (int p = 0; p < aantal; p++)
+		vertaald [p] = vertaal (bestanden [p], optimaliseren, programmas [p], meldingen [p]);
+
+	vector<vector<Uitslag> > uitslagen (campagne.aantal);
+	const Doorvoer doorvoer = voerCampagneUit (campagne, [&] (int nummer, Wereld& wereld, Arena& arena)
+	{
+		Taak deze = taak;
+		bereidVoor (deze, wereld);
+		uitslagen [nummer].resize (aantal);
+		for (int p = 0; p < aantal; p++)
+			if (vertaald [p])
+				uitslagen [nummer][p] = draai (programmas [p], wereld, maximum, deze, &arena);
+	});
+
+	uit << setprecision (6) << fixed;
+	uit << "{\n  \"schema\": 1,\n";
+	uit << "  \"campaign\": { \"kind\": \"" << wereldNaam (campagne.soort) << "\", \"worlds\": " << campagne.aantal
+		<< ", \"width\": " << campagne.breedte << ", \"height\": " << campagne.hoogte << ", \"seed\": " << campagne.zaad
+		<< ", \"generator_threads\": " << campagne.generatoren << ", \"evaluator_threads\": " << campagne.evaluatoren
+		<< ", \"queue_capacity\": " << campagne.capaciteit << ", \"seconds\": " << doorvoer.seconden
+		<< ", \"queue_high_water\": " << doorvoer.hoogste_stand << ", \"worlds_allocated\": " << doorvoer.nieuwe_werelden << ",\n    ";
+	schrijfFase (uit, "generation", doorvoer.generatie, campagne.generatoren);
+	uit << ",\n    ";
+	schrijfFase (uit, "evaluation", doorvoer.evaluatie, campagne.evaluatoren);
+	uit << ",\n    \"arena\": { \"allocations\": " << doorvoer.arena.allocaties << ", \"bytes\": " << doorvoer.arena.bytes
+		<< ", \"blocks\": " << doorvoer.arena.blokken << ", \"high_water_bytes\": " << doorvoer.arena.hoogste << " } },\n";
+	uit << "  \"programs\": [\n";
+
+	int geslaagd = 0;
+	for (int p = 0; p < aantal; p++)
+	{
+		uit << "    { \"program\": " << alsJSON (bestanden [p]);
+		if (!vertaald [p])
+			uit << ", \"status\": \"compile_error\"" << meldingen [p];
+		else
+		{
+			long long klaar = 0, gedaan = 0, instructies = 0, acties = 0;
+			double run_ms = 0, efficientie = 0;
+			for (int w = 0; w < campagne.aantal; w++)
+			{
+				const Uitslag& u = uitslagen [w][p];
+				klaar		+= u.geslaagd;
+				gedaan		+= u.taak_gedaan;
+				instructies	+= u.instructies;
+				acties		+= u.acties;
+				run_ms		+= u.run_ms;
+				efficientie	+= u.efficientie;
+			}
+			uit << ", \"worlds\": " << campagne.aantal << ", \"finished\": " << klaar
+				<< ", \"instructions\": " << instructies << ", \"actions\": " << acties << ", \"run_ms\": " << run_ms;
+			if (taak.soort != Taak::Geen)
+				uit << ", \"task_done\": " << gedaan << ", \"efficiency\": " << efficientie / campagne.aantal;
+			if (klaar == campagne.aantal)
+				geslaagd++;
+		}
+		uit << " }" << (p + 1 < aantal ? ",\n" : "\n");
+	}
+	uit << "  ]\n}\n";
+
+	cerr << geslaagd << " of " << aantal << " programs finished on all " << campagne.aantal << " worlds" << endl;
+	return geslaagd == aantal ? 0 : 1;
+}
+
+int main (int argc, char *argv [])
+{
+	const char	*wereld_bestand = NULL;
+	const char	*uitvoer        = NULL;
+	bool		met_doolhof     = false;
+	Doolhof		doolhof;
+	bool		met_campagne    = false;
+	const int	processors      = max ((int) thread::hardware_concurrency (), 1);
+	Campagne	campagne;
+	campagne.zaad			= 1;
+	campagne.generatoren	= max (processors / 4, 1);
+	campagne.evaluatoren	= max (processors - campagne.generatoren, 1);
+	campagne.capaciteit	= 64;
+	long long	maximum         = 1000000000LL;
+	bool		optimaliseren   = true;
+	Taak		taak;
+	taak.soort = Taak::Geen;
+	int			eerste          = argc;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp (argv [i], "--world") == 0 && i + 1 < argc)
+			wereld_bestand = argv [++i];
+		else if (strcmp (argv [i], "--maze") == 0 && i + 1 < argc)
+		{
+			if (!leesDoolhof (argv [++i], doolhof))
+			{
+				cerr << "Unknown maze " << argv [i] << "; use backtracker, kruskal or wilson:seed:WxH, at least 3x3" << endl;
+				return 2;
+			}
+			met_doolhof = true;
+		}
+		else if (strcmp (argv [i], "--campaign") == 0 && i + 1 < argc)
+		{
+			if (!leesCampagne (argv [++i], campagne))
+			{
+				cerr << "Unknown campaign " << argv [i] << "; use cave, chaos, path or maze:count[:WxH], at least 20x20" << endl;
+				return 2;
+			}
+			met_campagne = true;
+		}
+		else if (strcmp (argv [i], "--seed") == 0 && i + 1 < argc)
+			campagne.zaad = strtoull (argv [++i], NULL, 10);
+		else if (strcmp (argv [i], "--threads") == 0 && i + 1 < argc)
+		{
+			if (sscanf (argv [++i], "%d,%d", &campagne.generatoren, &campagne.evaluatoren) != 2 || campagne.generatoren < 1 || campagne.evaluatoren < 1)
+			{
+				cerr << "Use --threads g,e with at least one generator and one evaluator thread" << endl;
+				return 2;
+			}
+		}
+		else if (strcmp (argv [i], "--queue") == 0 && i + 1 < argc)
+			campagne.capaciteit = max (atoi (argv [++i]), 1);
+		else if (strcmp (argv [i], "--max") == 0 && i + 1 < argc)
+			maximum = atoll (argv [++i]);
+		else if (strcmp (argv [i], "--no-optimise") == 0)
+			optimaliseren = false;
+		else if (strcmp (argv [i], "--task") == 0 && i + 1 < argc)
+		{
+			if (!leesTaak (argv [++i], taak))
+			{
+				cerr << "Unknown task " << argv [i] << "; use reach:x,y, collect or fill" << endl;
+				return 2;
+			}
+		}
+		else if (strcmp (argv [i], "--out") == 0 && i + 1 < argc)
+			uitvoer = argv [++i];
+		else if (argv [i][0] == '-')
+		{
+			eerste = argc;
+			break;
+		}
+		else
+		{
+			eerste = i;
+			break;
+		}
+	}
+	if (eerste >= argc)
+	{
+		cerr << "Usage: " << argv [0] << " [--world file | --maze kind:seed:WxH | --campaign kind:count[:WxH]] [--seed n] [--threads g,e] [--queue n]"
+				" [--max n] [--no-optimise] [--task task] [--out file.json] program..." << endl;
+		return 2;
+	}
+
+	ofstream bestand;
+	if (uitvoer != NULL)
+		bestand.open (uitvoer);
+	ostream& uit = (uitvoer != NULL) ? bestand : cout;
+
+	if (met_campagne)
+	{
+		if (taak.soort == Taak::Naar && (taak.x < 0 || taak.y < 0 || taak.x >= campagne.breedte || taak.y >= campagne.hoogte))
+		{
+			cerr << "The field of the task is outside the world" << endl;
+			return 2;
+		}
+		return evalueerCampagne (campagne, argv + eerste, argc - eerste, maximum, optimaliseren, taak, uit);
+	}
+
+	Wereld wereld;
+	if (met_doolhof)
+	{
+		wereld = Wereld (doolhof.breedte, doolhof.hoogte);
+		maakDoolhof (wereld, doolhof.soort, doolhof.zaad);
+	}
+	else if (wereld_bestand != NULL)
+		try
+		{
+			wereld.laad (wereld_bestand);
+		}
+		catch (IllegaleActie&)
+		{
+			cerr << "It was not possible to open the world " << wereld_bestand << endl;
+			return 2;
+		}
+
+	if (!bereidVoor (taak, wereld))
+	{
+		cerr << "The field of the task is outside the world" << endl;
+		return 2;
+	}
+
+	int geslaagd = 0;
+	uit << "{\n  \"schema\": 1,\n";
+	if (taak.soort != Taak::Geen)
+		uit << "  \"reference\": { \"task\": \"" << taakNaam (taak.soort) << "\", \"found\": " << (taak.referentie.gevonden ? "true" : "false")
+			<< ", \"actions\": " << taak.referentie.acties.size () << ", \"optimal\": " << (taak.referentie.optimaal ? "true" : "false") << " },\n";
+	uit << "  \"programs\": [\n";
+	for (int i = eerste; i < argc; i++)
+	{
+		bool ok;
+		uit << "    " << evalueer (argv [i], wereld, maximum, optimaliseren, taak, ok) << (i + 1 < argc ? ",\n" : "\n");
+		if (ok)
+			geslaagd++;
+	}
+	uit << "  ]\n}\n";
+
+	const int aantal = argc - eerste;
+	cerr << geslaagd << " of " << aantal << " programs finished" << endl;
+	return geslaagd == aantal ? 0 : 1;
+}